@@ -0,0 +1,667 @@
+
+// Many players ("agents", e.g. bots) simulated together.
+//
+// The state is stored as a structure of arrays, and a whole physics step runs on `AGENT_LANES` agents
+// at once with SSE2 or AVX2: gravity, the ground check, jumping and walking, velocity clamping, moving
+// and resolving the contacts. The branches of `stepPlayer` become masks, and the tiles around each box
+// (at most 2x2 of them for the player and its ground probe) are gathered two rows at a time into a
+// few bits per lane, so an agent ends up exactly where a `Player` with the same input would.
+// Only the rare agents that move further than `SWEEP_MAX_PENETRATION` in a step (they need a sweep)
+// or stand outside of the world on X go through the same code as `stepPlayer`, one at a time.
+//
+// AVX2 is used when the compiler targets it (e.g. -mavx2 or -march=native), otherwise SSE2 on x86-64,
+// otherwise `stepPlayer` is called for each agent.
+
+#include <stddef.h> // offsetof
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AGENT_LANES 8
+typedef __m256 AgentFloats;
+#define agentLoad(p) _mm256_loadu_ps(p)
+#define agentStore(p, v) _mm256_storeu_ps((p), (v))
+#define agentSet(f) _mm256_set1_ps(f)
+#define agentAdd(a, b) _mm256_add_ps((a), (b))
+#define agentSub(a, b) _mm256_sub_ps((a), (b))
+#define agentMul(a, b) _mm256_mul_ps((a), (b))
+#define agentDiv(a, b) _mm256_div_ps((a), (b))
+#define agentSqrt(a) _mm256_sqrt_ps(a)
+#define agentMin(a, b) _mm256_min_ps((a), (b))
+#define agentMax(a, b) _mm256_max_ps((a), (b))
+#define agentAbs(a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (a))
+#define agentNegate(a) _mm256_xor_ps(_mm256_set1_ps(-0.0f), (a))
+#define agentGreater(a, b) _mm256_cmp_ps((a), (b), _CMP_GT_OQ)
+#define agentGreaterEqual(a, b) _mm256_cmp_ps((a), (b), _CMP_GE_OQ)
+#define agentAnd(a, b) _mm256_and_ps((a), (b))
+#define agentAndNot(mask, a) _mm256_andnot_ps((mask), (a))
+#define agentOr(a, b) _mm256_or_ps((a), (b))
+#define agentSelect(mask, a, b) _mm256_blendv_ps((b), (a), (mask))
+#define agentMaskBits(mask) _mm256_movemask_ps(mask)
+#define agentFloorToInt(v) _mm256_cvttps_epi32(_mm256_floor_ps(v))
+typedef __m256i AgentInts;
+#define agentIntLoad(p) _mm256_loadu_si256((const __m256i*)(p))
+#define agentIntStore(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#define agentIntSet(i) _mm256_set1_epi32(i)
+#define agentIntAdd(a, b) _mm256_add_epi32((a), (b))
+#define agentIntSub(a, b) _mm256_sub_epi32((a), (b))
+#define agentIntAnd(a, b) _mm256_and_si256((a), (b))
+#define agentIntAndNot(mask, a) _mm256_andnot_si256((mask), (a))
+#define agentIntOr(a, b) _mm256_or_si256((a), (b))
+#define agentIntGreater(a, b) _mm256_cmpgt_epi32((a), (b))
+#define agentIntEqual(a, b) _mm256_cmpeq_epi32((a), (b))
+#define agentIntShiftLeft(a, n) _mm256_slli_epi32((a), (n))
+#define agentIntShiftRight(a, n) _mm256_srli_epi32((a), (n))
+// Each lane shifted by its own count
+#define agentIntShiftRightBy(a, n) _mm256_srlv_epi32((a), (n))
+#define agentIntToFloat(a) _mm256_cvtepi32_ps(a)
+#define agentIntAsMask(a) _mm256_castsi256_ps(a)
+#define agentMaskAsInts(mask) _mm256_castps_si256(mask)
+// Bit `lane` of every lane, to turn lane bits into a mask
+#define AGENT_LANE_BITS _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128)
+// The 32 bits at `rows + index` of every lane: row `index` in the low half, the next row in the high half
+#define agentGatherRowPairs(rows, index) _mm256_i32gather_epi32((const int*)(rows), (index), 2)
+// The 32 bits at `offset` in each lane's input, of `AGENT_LANES` inputs in a row
+#define agentGatherInputs(inputs, offset) \
+    _mm256_i32gather_epi32((const int*)((const char*)(inputs) + (offset)), \
+                           _mm256_setr_epi32(0, AGENT_INPUT_SIZE, 2 * AGENT_INPUT_SIZE, 3 * AGENT_INPUT_SIZE, \
+                                             4 * AGENT_INPUT_SIZE, 5 * AGENT_INPUT_SIZE, 6 * AGENT_INPUT_SIZE, 7 * AGENT_INPUT_SIZE), 1)
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define AGENT_LANES 4
+typedef __m128 AgentFloats;
+#define agentLoad(p) _mm_loadu_ps(p)
+#define agentStore(p, v) _mm_storeu_ps((p), (v))
+#define agentSet(f) _mm_set1_ps(f)
+#define agentAdd(a, b) _mm_add_ps((a), (b))
+#define agentSub(a, b) _mm_sub_ps((a), (b))
+#define agentMul(a, b) _mm_mul_ps((a), (b))
+#define agentDiv(a, b) _mm_div_ps((a), (b))
+#define agentSqrt(a) _mm_sqrt_ps(a)
+#define agentMin(a, b) _mm_min_ps((a), (b))
+#define agentMax(a, b) _mm_max_ps((a), (b))
+#define agentAbs(a) _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+#define agentNegate(a) _mm_xor_ps(_mm_set1_ps(-0.0f), (a))
+#define agentGreater(a, b) _mm_cmpgt_ps((a), (b))
+#define agentGreaterEqual(a, b) _mm_cmpge_ps((a), (b))
+#define agentAnd(a, b) _mm_and_ps((a), (b))
+#define agentAndNot(mask, a) _mm_andnot_ps((mask), (a))
+#define agentOr(a, b) _mm_or_ps((a), (b))
+// No blend in SSE2
+#define agentSelect(mask, a, b) _mm_or_ps(_mm_and_ps((mask), (a)), _mm_andnot_ps((mask), (b)))
+#define agentMaskBits(mask) _mm_movemask_ps(mask)
+// No floor in SSE2: truncate, then step down where truncation went up (negative numbers, the mask is -1)
+static inline __m128i
+agentFloorToIntSse2(__m128 v)
+{
+    const __m128i truncated = _mm_cvttps_epi32(v);
+    return _mm_add_epi32(truncated, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), v)));
+}
+#define agentFloorToInt(v) agentFloorToIntSse2(v)
+typedef __m128i AgentInts;
+#define agentIntLoad(p) _mm_loadu_si128((const __m128i*)(p))
+#define agentIntStore(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+#define agentIntSet(i) _mm_set1_epi32(i)
+#define agentIntAdd(a, b) _mm_add_epi32((a), (b))
+#define agentIntSub(a, b) _mm_sub_epi32((a), (b))
+#define agentIntAnd(a, b) _mm_and_si128((a), (b))
+#define agentIntAndNot(mask, a) _mm_andnot_si128((mask), (a))
+#define agentIntOr(a, b) _mm_or_si128((a), (b))
+#define agentIntGreater(a, b) _mm_cmpgt_epi32((a), (b))
+#define agentIntEqual(a, b) _mm_cmpeq_epi32((a), (b))
+#define agentIntShiftLeft(a, n) _mm_slli_epi32((a), (n))
+#define agentIntShiftRight(a, n) _mm_srli_epi32((a), (n))
+// No variable shifts in SSE2: multiply by 2^-n (127 - n in the exponent bits) and truncate,
+// exact for `a` below 2^24 since the float holds it whole
+#define agentIntShiftRightBy(a, n) \
+    _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(a), _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127), (n)), 23))))
+#define agentIntToFloat(a) _mm_cvtepi32_ps(a)
+#define agentIntAsMask(a) _mm_castsi128_ps(a)
+#define agentMaskAsInts(mask) _mm_castps_si128(mask)
+#define AGENT_LANE_BITS _mm_setr_epi32(1, 2, 4, 8)
+// No gather in SSE2 either, one load per lane. The lanes are put together in registers, a vector
+// load right after four smaller stores would wait for them to reach the cache.
+static inline __m128i
+agentCombineLanesSse2(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+    const __m128i low = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)a), _mm_cvtsi32_si128((int)b));
+    const __m128i high = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)c), _mm_cvtsi32_si128((int)d));
+    return _mm_unpacklo_epi64(low, high);
+}
+static inline __m128i
+agentGatherRowPairsSse2(const uint16_t* rows, __m128i index)
+{
+    uint32_t pairs[4];
+    for (int lane = 0; lane < 4; lane++) {
+        memcpy(&pairs[lane], rows + _mm_cvtsi128_si32(index), sizeof(uint32_t));
+        index = _mm_srli_si128(index, 4);
+    }
+    return agentCombineLanesSse2(pairs[0], pairs[1], pairs[2], pairs[3]);
+}
+#define agentGatherRowPairs(rows, index) agentGatherRowPairsSse2((rows), (index))
+static inline __m128i
+agentGatherInputsSse2(const PlayerInput* inputs, size_t offset)
+{
+    uint32_t words[4];
+    for (int lane = 0; lane < 4; lane++) {
+        memcpy(&words[lane], (const char*)&inputs[lane] + offset, sizeof(uint32_t));
+    }
+    return agentCombineLanesSse2(words[0], words[1], words[2], words[3]);
+}
+#define agentGatherInputs(inputs, offset) agentGatherInputsSse2((inputs), (offset))
+#else
+#define AGENT_LANES 1
+#endif
+
+#if AGENT_LANES > 1
+#define AGENT_INPUT_SIZE ((int)sizeof(PlayerInput))
+// The buttons of an input are read together from its first 32 bits (see `getAgentInputFlag`),
+// and `isGamepad` from the 32 bits it starts, which have to stay inside of the input
+typedef char agentInputButtonsCheck[offsetof(PlayerInput, isLeftDown) < sizeof(uint32_t) ? 1 : -1];
+typedef char agentInputGamepadCheck[offsetof(PlayerInput, isGamepad) + sizeof(uint32_t) <= sizeof(PlayerInput) ? 1 : -1];
+#define agentMaskFromBits(bits) agentIntAsMask(agentIntEqual(agentIntAnd(agentIntSet(bits), AGENT_LANE_BITS), AGENT_LANE_BITS))
+#endif
+
+// Bits of `AgentBatch.flags`
+#define AGENT_ON_GROUND (1 << 0)
+#define AGENT_FACING_RIGHT (1 << 1)
+// Only during `stepAgents`: the move was too long to make without a sweep
+#define AGENT_LONG_MOVE (1 << 2)
+
+typedef struct {
+    size_t count;
+    size_t capacity; // Multiple of `AGENT_LANES`, the lanes past `count` are stepped along but never read
+
+    float* positionX;
+    float* positionY;
+    float* velocityX;
+    float* velocityY;
+    float* jumpHoldTime;
+    int* flags;
+
+    // Scratch space for the step: the `PlayerEvent` flags of each agent
+    int* events;
+} AgentBatch;
+
+void*
+allocateAgentArray(size_t count, size_t itemSize)
+{
+    void* array = calloc(count, itemSize);
+    if (!array) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+void
+createAgentBatch(AgentBatch* batch, size_t count)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->count = count;
+    batch->capacity = (count + AGENT_LANES - 1) / AGENT_LANES * AGENT_LANES;
+
+    batch->positionX = (float*)allocateAgentArray(batch->capacity, sizeof(float));
+    batch->positionY = (float*)allocateAgentArray(batch->capacity, sizeof(float));
+    batch->velocityX = (float*)allocateAgentArray(batch->capacity, sizeof(float));
+    batch->velocityY = (float*)allocateAgentArray(batch->capacity, sizeof(float));
+    batch->jumpHoldTime = (float*)allocateAgentArray(batch->capacity, sizeof(float));
+    batch->flags = (int*)allocateAgentArray(batch->capacity, sizeof(int));
+    batch->events = (int*)allocateAgentArray(batch->capacity, sizeof(int));
+}
+
+void
+freeAgentBatch(AgentBatch* batch)
+{
+    free(batch->positionX);
+    free(batch->positionY);
+    free(batch->velocityX);
+    free(batch->velocityY);
+    free(batch->jumpHoldTime);
+    free(batch->flags);
+    free(batch->events);
+    memset(batch, 0, sizeof(*batch));
+}
+
+Player
+getAgent(const AgentBatch* batch, size_t i)
+{
+    Player agent = player;
+    agent.position.x = batch->positionX[i];
+    agent.position.y = batch->positionY[i];
+    agent.velocity.x = batch->velocityX[i];
+    agent.velocity.y = batch->velocityY[i];
+    agent.jumpHoldTime = batch->jumpHoldTime[i];
+    agent.animTime = 0.0f;
+    agent.isOnGround = batch->flags[i] & AGENT_ON_GROUND;
+    agent.isFacingRight = batch->flags[i] & AGENT_FACING_RIGHT;
+    return agent;
+}
+
+void
+setAgent(AgentBatch* batch, size_t i, const Player* agent)
+{
+    batch->positionX[i] = agent->position.x;
+    batch->positionY[i] = agent->position.y;
+    batch->velocityX[i] = agent->velocity.x;
+    batch->velocityY[i] = agent->velocity.y;
+    batch->jumpHoldTime[i] = agent->jumpHoldTime;
+    batch->flags[i] = (agent->isOnGround ? AGENT_ON_GROUND : 0) | (agent->isFacingRight ? AGENT_FACING_RIGHT : 0);
+}
+
+// Lanes of the agents from `i` on that are in the batch
+int
+getAgentLanes(const AgentBatch* batch, size_t i)
+{
+    const size_t lanes = batch->count - i;
+    return lanes >= AGENT_LANES ? (1 << AGENT_LANES) - 1 : (1 << lanes) - 1;
+}
+
+#if AGENT_LANES > 1
+#define agentIntSelect(mask, a, b) agentIntOr(agentIntAnd((mask), (a)), agentIntAndNot((mask), (b)))
+
+// Bit of tile [column, row] in `AgentTiles.neighborhood`, counted from the box's first tile (-1 to 2 each)
+#define AGENT_TILE_BIT(column, row) (1 << (((row) + 1) * 4 + (column) + 1))
+
+// The four tiles of `row` from column `startX - 1` on, as row `neighborhoodRow` of `AgentTiles.neighborhood`
+static inline AgentInts
+getAgentNeighborhoodRow(AgentInts row, AgentInts startX, int neighborhoodRow)
+{
+    // Column x to bit x + 1, with the columns next to the world (`OUTSIDE_TILE_HORIZONTAL`) in bit 0 and bit `TILEMAP_SIZE_X + 1`
+    const AgentInts outside = agentIntSet(OUTSIDE_TILE_HORIZONTAL == TILE_FULL ? 1 | 1 << (TILEMAP_SIZE_X + 1) : 0);
+    const AgentInts columns = agentIntShiftRightBy(agentIntOr(agentIntShiftLeft(row, 1), outside), startX);
+    return agentIntAnd(agentIntShiftLeft(columns, 4 * neighborhoodRow), agentIntSet(0xf << (4 * neighborhoodRow)));
+}
+
+// Rows `y` and `y + 1` (counted from `world->topY`) of every lane, as rows `neighborhoodRow` and
+// `neighborhoodRow + 1` of `AgentTiles.neighborhood`. Rows outside of the world are `OUTSIDE_TILE_VERTICAL`.
+// The world needs at least two rows.
+static inline AgentInts
+gatherAgentRowPair(const WorldSolids* world, AgentInts y, AgentInts startX, int neighborhoodRow)
+{
+    // Both rows are read with 32 bits. A pair that sticks out of the world is read from inside of it
+    // and shifted back into place, so nothing is read outside of the world.
+    const AgentInts lastPairY = agentIntSet(world->rowCount - 2);
+    const AgentInts isAbove = agentIntGreater(agentIntSet(0), y);
+    const AgentInts isPastLast = agentIntGreater(y, lastPairY);
+    const AgentInts pairY = agentIntAndNot(isAbove, agentIntSelect(isPastLast, lastPairY, y));
+    AgentInts pairs = agentGatherRowPairs(world->rows, pairY);
+    pairs = agentIntSelect(isPastLast, agentIntShiftRight(pairs, 16), pairs);
+    pairs = agentIntSelect(isAbove, agentIntShiftLeft(pairs, 16), pairs);
+
+    const AgentInts isFirstOutside = agentIntOr(isAbove, agentIntGreater(y, agentIntSet(world->rowCount - 1)));
+    const AgentInts isSecondOutside = agentIntOr(agentIntGreater(agentIntSet(-1), y), isPastLast);
+    const AgentInts outsideBits = agentIntOr(agentIntAnd(isFirstOutside, agentIntSet(TILEMAP_SOLIDS_ROW_FULL)),
+                                             agentIntAnd(isSecondOutside, agentIntSet(TILEMAP_SOLIDS_ROW_FULL << 16)));
+    pairs = OUTSIDE_TILE_VERTICAL == TILE_FULL ? agentIntOr(pairs, outsideBits) : agentIntAndNot(outsideBits, pairs);
+
+    const AgentInts first = agentIntAnd(pairs, agentIntSet(TILEMAP_SOLIDS_ROW_FULL));
+    const AgentInts second = agentIntAnd(agentIntShiftRight(pairs, 16), agentIntSet(TILEMAP_SOLIDS_ROW_FULL));
+    return agentIntOr(getAgentNeighborhoodRow(first, startX, neighborhoodRow), getAgentNeighborhoodRow(second, startX, neighborhoodRow + 1));
+}
+
+// The tiles around a box of every lane, for boxes of at most 2x2 tiles inside of the world on X
+typedef struct {
+    AgentFloats tileX; // Center of the box's first column, the second one is one tile further
+    AgentFloats tileY; // Center of the box's first row
+    AgentInts neighborhood; // The full tiles from the one above and left of the box to the one below and right of it
+    AgentInts boxTiles; // The bits of `neighborhood` the box covers (none for the other lanes)
+    int otherLanes; // Bigger boxes and the ones outside of the world on X
+} AgentTiles;
+
+// Same tile range as `getTilesOverlappedByBox`. The rows above and below the box are only read
+// `withNeighborRows`, for `resolveAgentTile`.
+static inline void
+getAgentTiles(AgentTiles* tiles, const WorldSolids* world, AgentFloats centerX, AgentFloats centerY,
+              AgentFloats sizeX, AgentFloats sizeY, bool withNeighborRows)
+{
+    const AgentInts zero = agentIntSet(0);
+    const AgentInts one = agentIntSet(1);
+    AgentInts startX = agentFloorToInt(agentSub(centerX, sizeX));
+    const AgentInts startY = agentFloorToInt(agentSub(centerY, sizeY));
+    const AgentInts width = agentIntSub(agentFloorToInt(agentAdd(centerX, sizeX)), startX);
+    const AgentInts height = agentIntSub(agentFloorToInt(agentAdd(centerY, sizeY)), startY);
+
+    AgentInts isOther = agentIntGreater(zero, startX);
+    isOther = agentIntOr(isOther, agentIntGreater(agentIntAdd(startX, width), agentIntSet(TILEMAP_SIZE_X - 1)));
+    isOther = agentIntOr(isOther, agentIntGreater(width, one));
+    isOther = agentIntOr(isOther, agentIntGreater(zero, width));
+    isOther = agentIntOr(isOther, agentIntGreater(height, one));
+    isOther = agentIntOr(isOther, agentIntGreater(zero, height));
+    tiles->otherLanes = agentMaskBits(agentIntAsMask(isOther));
+
+    tiles->tileX = agentAdd(agentSet(0.5f), agentIntToFloat(startX));
+    tiles->tileY = agentAdd(agentSet(0.5f), agentIntToFloat(startY));
+    startX = agentIntAndNot(isOther, startX);
+    const AgentInts rowY = agentIntSub(startY, agentIntSet(world->topY));
+    if (withNeighborRows) {
+        tiles->neighborhood = agentIntOr(gatherAgentRowPair(world, agentIntSub(rowY, one), startX, 0),
+                                         gatherAgentRowPair(world, agentIntAdd(rowY, one), startX, 2));
+    } else {
+        tiles->neighborhood = gatherAgentRowPair(world, rowY, startX, 1);
+    }
+
+    const AgentInts isWide = agentIntEqual(width, one);
+    const AgentInts isTall = agentIntEqual(height, one);
+    AgentInts boxTiles = agentIntSet(AGENT_TILE_BIT(0, 0));
+    boxTiles = agentIntOr(boxTiles, agentIntAnd(isWide, agentIntSet(AGENT_TILE_BIT(1, 0))));
+    boxTiles = agentIntOr(boxTiles, agentIntAnd(isTall, agentIntSet(AGENT_TILE_BIT(0, 1))));
+    boxTiles = agentIntOr(boxTiles, agentIntAnd(agentIntAnd(isWide, isTall), agentIntSet(AGENT_TILE_BIT(1, 1))));
+    tiles->boxTiles = agentIntAndNot(isOther, agentIntAnd(boxTiles, tiles->neighborhood));
+}
+
+// Lanes where tile [column, row] of the box (0 or 1 each) is there and full
+static inline AgentFloats
+isAgentTileFull(const AgentTiles* tiles, int column, int row)
+{
+    return agentIntAsMask(agentIntGreater(agentIntAnd(tiles->boxTiles, agentIntSet(AGENT_TILE_BIT(column, row))), agentIntSet(0)));
+}
+
+// Lanes whose box touches any full tile, same test as `isBoxCollidingWithTilemap`
+static inline AgentFloats
+isAgentBoxColliding(const AgentTiles* tiles, AgentFloats centerX, AgentFloats centerY, AgentFloats sizeX, AgentFloats sizeY)
+{
+    const AgentFloats zero = agentSet(0.0f);
+    const AgentFloats one = agentSet(1.0f);
+    const AgentFloats sizeSumX = agentAdd(sizeX, agentSet(0.5f));
+    const AgentFloats sizeSumY = agentAdd(sizeY, agentSet(0.5f));
+    // The distance between the surfaces is larger than zero on the axis
+    const AgentFloats isApartX0 = agentGreater(agentSub(agentAbs(agentSub(centerX, tiles->tileX)), sizeSumX), zero);
+    const AgentFloats isApartX1 = agentGreater(agentSub(agentAbs(agentSub(centerX, agentAdd(tiles->tileX, one))), sizeSumX), zero);
+    const AgentFloats isApartY0 = agentGreater(agentSub(agentAbs(agentSub(centerY, tiles->tileY)), sizeSumY), zero);
+    const AgentFloats isApartY1 = agentGreater(agentSub(agentAbs(agentSub(centerY, agentAdd(tiles->tileY, one))), sizeSumY), zero);
+
+    AgentFloats isColliding = agentAndNot(agentOr(isApartX0, isApartY0), isAgentTileFull(tiles, 0, 0));
+    isColliding = agentOr(isColliding, agentAndNot(agentOr(isApartX0, isApartY1), isAgentTileFull(tiles, 0, 1)));
+    isColliding = agentOr(isColliding, agentAndNot(agentOr(isApartX1, isApartY0), isAgentTileFull(tiles, 1, 0)));
+    isColliding = agentOr(isColliding, agentAndNot(agentOr(isApartX1, isApartY1), isAgentTileFull(tiles, 1, 1)));
+    return isColliding;
+}
+
+// Lanes where the tile at `bit` of the neighborhood is empty
+static inline AgentFloats
+isAgentNeighborEmpty(const AgentTiles* tiles, AgentInts bit)
+{
+    return agentIntAsMask(agentIntEqual(agentIntAnd(tiles->neighborhood, bit), agentIntSet(0)));
+}
+
+// One tile of `resolveBoxCollisionWithTilemap` for every lane, returns the lanes that were clipped
+static inline AgentFloats
+resolveAgentTile(const AgentTiles* tiles, int column, int row, AgentFloats sizeSumX, AgentFloats sizeSumY,
+                 AgentFloats* centerX, AgentFloats* centerY, AgentFloats* velocityX, AgentFloats* velocityY)
+{
+    const AgentFloats zero = agentSet(0.0f);
+    // The tile centers are whole numbers + 0.5, adding the column or row is exact
+    const AgentFloats boxX = column ? agentAdd(tiles->tileX, agentSet(1.0f)) : tiles->tileX;
+    const AgentFloats boxY = row ? agentAdd(tiles->tileY, agentSet(1.0f)) : tiles->tileY;
+    const AgentFloats surfDistX = agentSub(agentAbs(agentSub(*centerX, boxX)), sizeSumX);
+    const AgentFloats surfDistY = agentSub(agentAbs(agentSub(*centerY, boxY)), sizeSumY);
+    const AgentFloats isTouching = agentAndNot(agentOr(agentGreater(surfDistX, zero), agentGreater(surfDistY, zero)),
+                                               isAgentTileFull(tiles, column, row));
+    // The tiles above the feet are seldom touched, the ones under them mostly are
+    if (row == 0 && !agentMaskBits(isTouching)) return isTouching;
+
+    // The box collides with the edges towards its center, where the neighboring tile is empty
+    const AgentFloats isRight = agentGreater(*centerX, boxX);
+    const AgentFloats isBelow = agentGreater(*centerY, boxY);
+    const AgentFloats isXEmpty = isAgentNeighborEmpty(tiles, agentIntSelect(agentMaskAsInts(isRight), agentIntSet(AGENT_TILE_BIT(column + 1, row)),
+                                                                            agentIntSet(AGENT_TILE_BIT(column - 1, row))));
+    const AgentFloats isYEmpty = isAgentNeighborEmpty(tiles, agentIntSelect(agentMaskAsInts(isBelow), agentIntSet(AGENT_TILE_BIT(column, row + 1)),
+                                                                            agentIntSet(AGENT_TILE_BIT(column, row - 1))));
+    const AgentFloats isClipped = agentAnd(isTouching, agentOr(isXEmpty, isYEmpty));
+
+    // With two edges, the axis with the least penetration
+    const AgentFloats isClipAxisX = agentAndNot(agentAndNot(agentGreater(surfDistX, surfDistY), isYEmpty), isXEmpty);
+    const AgentFloats isClipX = agentAnd(isClipped, isClipAxisX);
+    const AgentFloats isClipY = agentAndNot(isClipAxisX, isClipped);
+
+    const AgentFloats isBounce = agentAnd(isClipX, agentSelect(isRight, agentGreater(zero, *velocityX), agentGreater(*velocityX, zero)));
+    *centerX = agentSelect(isClipX, agentSelect(isRight, agentAdd(boxX, sizeSumX), agentSub(boxX, sizeSumX)), *centerX);
+    *velocityX = agentSelect(isBounce, agentMul(agentNegate(*velocityX), agentSet(BOUNCE_FACTOR_X)), *velocityX);
+    *centerY = agentSelect(isClipY, agentSelect(isBelow, agentAdd(boxY, sizeSumY), agentSub(boxY, sizeSumY)), *centerY);
+    *velocityY = agentSelect(isClipY, agentSelect(isBelow, agentMax(*velocityY, zero), agentMin(*velocityY, zero)), *velocityY);
+    return isClipped;
+}
+
+// The `bool` at byte `offset` of `words` (32 bits of each lane's input), as a mask
+static inline AgentFloats
+getAgentInputFlag(AgentInts words, size_t offset)
+{
+    const AgentInts isFalse = agentIntEqual(agentIntAnd(words, agentIntSet((int)(0xffu << (8 * offset)))), agentIntSet(0));
+    return agentIntAsMask(agentIntAndNot(isFalse, agentIntSet(-1)));
+}
+
+// `applyPlayerGroundInput` for the lanes in `isOnGround`, `inputs` has one input per lane.
+// Returns the lanes that jumped.
+static inline AgentFloats
+applyAgentGroundInput(AgentFloats isOnGround, const PlayerInput* inputs, float delta, AgentFloats* velocityX,
+                      AgentFloats* velocityY, AgentFloats* jumpHoldTime, AgentFloats* isFacingRight)
+{
+    const AgentInts buttons = agentGatherInputs(inputs, 0);
+    AgentFloats isRight = getAgentInputFlag(buttons, offsetof(PlayerInput, isRightDown));
+    AgentFloats isLeft = getAgentInputFlag(buttons, offsetof(PlayerInput, isLeftDown));
+    const AgentFloats isJump = agentAnd(isOnGround, getAgentInputFlag(buttons, offsetof(PlayerInput, isJumpReleased)));
+    const AgentFloats isJumpDown = agentAnd(isOnGround, getAgentInputFlag(buttons, offsetof(PlayerInput, isJumpDown)));
+    const AgentFloats isWalk = agentAndNot(isJumpDown, isOnGround);
+
+    // Same as `isPlayerInputRight` and `isPlayerInputLeft`
+    const AgentFloats isGamepad = getAgentInputFlag(agentGatherInputs(inputs, offsetof(PlayerInput, isGamepad)), 0);
+    if (agentMaskBits(isGamepad)) {
+        const AgentFloats stickX = agentIntAsMask(agentGatherInputs(inputs, offsetof(PlayerInput, stickX)));
+        isRight = agentOr(isRight, agentAnd(isGamepad, agentGreaterEqual(stickX, agentSet(0.0f))));
+        isLeft = agentOr(isLeft, agentAnd(isGamepad, agentGreaterEqual(agentSet(0.0f), stickX)));
+    }
+
+    // Same operations as the jump in `applyPlayerGroundInput`, with the hold time from before this step
+    *velocityX = agentAndNot(isOnGround, *velocityX);
+    if (agentMaskBits(isJump)) {
+        const AgentFloats jumpStrength = agentMul(agentMin(agentMax(agentMul(*jumpHoldTime, agentSet(2.6f)), agentSet(1.1f)), agentSet(2.0f)),
+                                                  agentSet(0.5f));
+        const AgentFloats xMoveStrength = agentSub(agentSet(0.75f), agentMul(jumpStrength, agentSet(0.5f)));
+        AgentFloats dirX = agentSet(0.0f);
+        const AgentFloats dirY = agentSet(-1.0f);
+        dirX = agentSelect(isRight, agentAdd(dirX, xMoveStrength), dirX);
+        dirX = agentSelect(isLeft, agentSub(dirX, xMoveStrength), dirX);
+        const AgentFloats inverseLength = agentDiv(agentSet(1.0f), agentSqrt(agentAdd(agentMul(dirX, dirX), agentMul(dirY, dirY))));
+        const AgentFloats jumpScale = agentMul(jumpStrength, agentSet(PLAYER_JUMP_STRENGTH));
+        *velocityX = agentSelect(isJump, agentMul(agentMul(dirX, inverseLength), jumpScale), *velocityX);
+        *velocityY = agentSelect(isJump, agentMul(agentMul(dirY, inverseLength), jumpScale), *velocityY);
+    }
+    *jumpHoldTime = agentAnd(isJumpDown, agentAdd(*jumpHoldTime, agentSet(delta)));
+
+    const AgentFloats walkSpeed = agentSet(PLAYER_SPEED * delta);
+    const AgentFloats isWalkRight = agentAnd(isWalk, isRight);
+    const AgentFloats isWalkLeft = agentAnd(isWalk, isLeft);
+    *velocityX = agentSelect(isWalkRight, agentAdd(*velocityX, walkSpeed), *velocityX);
+    *velocityX = agentSelect(isWalkLeft, agentSub(*velocityX, walkSpeed), *velocityX);
+    *isFacingRight = agentAndNot(isWalkLeft, agentOr(*isFacingRight, isWalkRight));
+    return isJump;
+}
+
+// Gravity and the ground check for the agents [i, i + AGENT_LANES), `lanes` are the ones in the batch
+static void
+checkAgentsGround(AgentBatch* batch, const WorldSolids* world, float delta, size_t i, int lanes)
+{
+    agentStore(&batch->velocityY[i], agentAdd(agentLoad(&batch->velocityY[i]), agentSet(PLAYER_GRAVITY * delta)));
+
+    // The probe is under the feet
+    AgentTiles tiles;
+    const AgentFloats positionX = agentLoad(&batch->positionX[i]);
+    const AgentFloats probeY = agentAdd(agentLoad(&batch->positionY[i]), agentSet(PLAYER_SIZE.y));
+    const AgentFloats probeSizeX = agentSet(PLAYER_GROUND_PROBE_SIZE.x);
+    const AgentFloats probeSizeY = agentSet(PLAYER_GROUND_PROBE_SIZE.y);
+    getAgentTiles(&tiles, world, positionX, probeY, probeSizeX, probeSizeY, false);
+    AgentFloats isOnGround = isAgentBoxColliding(&tiles, positionX, probeY, probeSizeX, probeSizeY);
+    const int otherLanes = tiles.otherLanes & lanes;
+    if (otherLanes) {
+        int groundLanes = agentMaskBits(isOnGround) & ~otherLanes;
+        for (int lane = 0; otherLanes >> lane; lane++) {
+            if (!((otherLanes >> lane) & 1)) continue;
+            const size_t agent = i + (size_t)lane;
+            const Vector2 center = { batch->positionX[agent], batch->positionY[agent] + PLAYER_SIZE.y };
+            if (isBoxCollidingWithTilemap(world, center, PLAYER_GROUND_PROBE_SIZE)) groundLanes |= 1 << lane;
+        }
+        isOnGround = agentMaskFromBits(groundLanes);
+    }
+
+    const AgentInts onGroundBit = agentIntSet(AGENT_ON_GROUND);
+    const AgentInts flags = agentIntLoad(&batch->flags[i]);
+    const AgentInts isOnGroundInts = agentMaskAsInts(isOnGround);
+    const AgentInts isLanding = agentIntAndNot(agentIntEqual(agentIntAnd(flags, onGroundBit), onGroundBit), isOnGroundInts);
+    agentIntStore(&batch->flags[i], agentIntOr(agentIntAndNot(onGroundBit, flags), agentIntAnd(isOnGroundInts, onGroundBit)));
+    agentIntStore(&batch->events[i], agentIntAnd(isLanding, agentIntSet(PLAYER_EVENT_LAND)));
+}
+
+// Jumping and walking, clamping the velocity and moving, for the agents [i, i + AGENT_LANES)
+static void
+moveAgents(AgentBatch* batch, const PlayerInput* inputs, float delta, size_t i, int lanes)
+{
+    const AgentFloats zero = agentSet(0.0f);
+    AgentFloats velocityX = agentLoad(&batch->velocityX[i]);
+    AgentFloats velocityY = agentLoad(&batch->velocityY[i]);
+    AgentFloats jumpHoldTime = agentLoad(&batch->jumpHoldTime[i]);
+    const AgentInts onGroundBit = agentIntSet(AGENT_ON_GROUND);
+    const AgentInts facingRightBit = agentIntSet(AGENT_FACING_RIGHT);
+    const AgentInts flags = agentIntLoad(&batch->flags[i]);
+    const AgentFloats isOnGround = agentIntAsMask(agentIntEqual(agentIntAnd(flags, onGroundBit), onGroundBit));
+    AgentFloats isFacingRight = agentIntAsMask(agentIntEqual(agentIntAnd(flags, facingRightBit), facingRightBit));
+
+    AgentFloats isJump = zero;
+    if (agentMaskBits(isOnGround) & lanes) {
+        // The last block can be short, its inputs are copied so nothing is read past the end
+        const PlayerInput* laneInputs = &inputs[i];
+        PlayerInput lastInputs[AGENT_LANES];
+        if (i + AGENT_LANES > batch->count) {
+            memset(lastInputs, 0, sizeof(lastInputs));
+            memcpy(lastInputs, &inputs[i], (batch->count - i) * sizeof(PlayerInput));
+            laneInputs = lastInputs;
+        }
+        isJump = applyAgentGroundInput(isOnGround, laneInputs, delta, &velocityX, &velocityY, &jumpHoldTime, &isFacingRight);
+    } else {
+        jumpHoldTime = zero;
+    }
+
+    // Same operations as Vector2Normalize + Vector2Scale in `updatePlayer`
+    const AgentFloats length = agentSqrt(agentAdd(agentMul(velocityX, velocityX), agentMul(velocityY, velocityY)));
+    const AgentFloats isMoving = agentGreater(length, zero);
+    const AgentFloats inverseLength = agentDiv(agentSet(1.0f), length);
+    const AgentFloats speed = agentMin(length, agentSet(PLAYER_MAX_SPEED));
+    velocityX = agentAnd(isMoving, agentMul(agentMul(velocityX, inverseLength), speed));
+    velocityY = agentAnd(isMoving, agentMul(agentMul(velocityY, inverseLength), speed));
+
+    // Moves longer than `SWEEP_MAX_PENETRATION` on an axis might need to stop at a wall
+    // (see `limitBoxMotion`), those are left for the contacts.
+    const AgentFloats motionX = agentMul(velocityX, agentSet(delta));
+    const AgentFloats motionY = agentMul(velocityY, agentSet(delta));
+    const AgentFloats isLong = agentGreater(agentMax(agentAbs(motionX), agentAbs(motionY)), agentSet(SWEEP_MAX_PENETRATION));
+    agentStore(&batch->positionX[i], agentAdd(agentLoad(&batch->positionX[i]), agentAndNot(isLong, motionX)));
+    agentStore(&batch->positionY[i], agentAdd(agentLoad(&batch->positionY[i]), agentAndNot(isLong, motionY)));
+    agentStore(&batch->velocityX[i], velocityX);
+    agentStore(&batch->velocityY[i], velocityY);
+    agentStore(&batch->jumpHoldTime[i], jumpHoldTime);
+
+    AgentInts newFlags = agentIntOr(agentIntAnd(flags, onGroundBit), agentIntAnd(agentMaskAsInts(isFacingRight), facingRightBit));
+    newFlags = agentIntOr(newFlags, agentIntAnd(agentMaskAsInts(isLong), agentIntSet(AGENT_LONG_MOVE)));
+    agentIntStore(&batch->flags[i], newFlags);
+    const AgentInts events = agentIntLoad(&batch->events[i]);
+    agentIntStore(&batch->events[i], agentIntOr(events, agentIntAnd(agentMaskAsInts(isJump), agentIntSet(PLAYER_EVENT_JUMP))));
+}
+
+// Long moves and contacts for the agents [i, i + AGENT_LANES), tile by tile in the same order as
+// `resolveBoxCollisionWithTilemap`
+static void
+resolveAgentsContacts(AgentBatch* batch, const WorldSolids* world, float delta, size_t i, int lanes, uint8_t* outEvents)
+{
+    AgentFloats positionX = agentLoad(&batch->positionX[i]);
+    AgentFloats positionY = agentLoad(&batch->positionY[i]);
+    AgentFloats velocityX = agentLoad(&batch->velocityX[i]);
+    AgentFloats velocityY = agentLoad(&batch->velocityY[i]);
+    const AgentInts flags = agentIntLoad(&batch->flags[i]);
+    const AgentInts onGroundBit = agentIntSet(AGENT_ON_GROUND);
+    const AgentInts longMoveBit = agentIntSet(AGENT_LONG_MOVE);
+    const AgentFloats isOnGround = agentIntAsMask(agentIntEqual(agentIntAnd(flags, onGroundBit), onGroundBit));
+    const AgentFloats isLong = agentIntAsMask(agentIntEqual(agentIntAnd(flags, longMoveBit), longMoveBit));
+
+    AgentTiles tiles;
+    const AgentFloats sizeX = agentSet(PLAYER_SIZE.x);
+    const AgentFloats sizeY = agentSet(PLAYER_SIZE.y);
+    getAgentTiles(&tiles, world, positionX, positionY, sizeX, sizeY, true);
+    tiles.boxTiles = agentIntAndNot(agentMaskAsInts(isLong), tiles.boxTiles);
+    AgentFloats isClipped = agentSet(0.0f);
+    const AgentFloats isAnyFull = agentIntAsMask(agentIntGreater(tiles.boxTiles, agentIntSet(0)));
+    if (agentMaskBits(isAnyFull)) {
+        const AgentFloats sizeSumX = agentAdd(sizeX, agentSet(0.5f));
+        const AgentFloats sizeSumY = agentAdd(sizeY, agentSet(0.5f));
+        isClipped = resolveAgentTile(&tiles, 0, 0, sizeSumX, sizeSumY, &positionX, &positionY, &velocityX, &velocityY);
+        isClipped = agentOr(isClipped, resolveAgentTile(&tiles, 0, 1, sizeSumX, sizeSumY, &positionX, &positionY, &velocityX, &velocityY));
+        isClipped = agentOr(isClipped, resolveAgentTile(&tiles, 1, 0, sizeSumX, sizeSumY, &positionX, &positionY, &velocityX, &velocityY));
+        isClipped = agentOr(isClipped, resolveAgentTile(&tiles, 1, 1, sizeSumX, sizeSumY, &positionX, &positionY, &velocityX, &velocityY));
+        agentStore(&batch->positionX[i], positionX);
+        agentStore(&batch->positionY[i], positionY);
+        agentStore(&batch->velocityX[i], velocityX);
+        agentStore(&batch->velocityY[i], velocityY);
+    }
+    agentIntStore(&batch->flags[i], agentIntAndNot(longMoveBit, flags));
+
+    int events[AGENT_LANES];
+    const AgentInts isBump = agentMaskAsInts(agentAndNot(isOnGround, isClipped));
+    agentIntStore(events, agentIntOr(agentIntLoad(&batch->events[i]), agentIntAnd(isBump, agentIntSet(PLAYER_EVENT_BUMP))));
+
+    // The long moves and the boxes outside of the world, one by one like `stepPlayer`
+    const int longLanes = agentMaskBits(isLong) & lanes;
+    const int otherLanes = (tiles.otherLanes | longLanes) & lanes;
+    for (int lane = 0; otherLanes >> lane; lane++) {
+        if (!((otherLanes >> lane) & 1)) continue;
+        const size_t agent = i + (size_t)lane;
+        Vector2 position = { batch->positionX[agent], batch->positionY[agent] };
+        Vector2 velocity = { batch->velocityX[agent], batch->velocityY[agent] };
+
+        if ((longLanes >> lane) & 1) {
+            const Vector2 motion = limitBoxMotion(world, position, PLAYER_SIZE, Vector2Scale(velocity, delta));
+            position = Vector2Add(position, motion);
+        }
+
+        const bool isAgentClipped = resolveBoxCollisionWithTilemap(world, &position, &velocity, PLAYER_SIZE);
+        if (isAgentClipped && !(batch->flags[agent] & AGENT_ON_GROUND)) events[lane] |= PLAYER_EVENT_BUMP;
+
+        batch->positionX[agent] = position.x;
+        batch->positionY[agent] = position.y;
+        batch->velocityX[agent] = velocity.x;
+        batch->velocityY[agent] = velocity.y;
+    }
+
+    if (outEvents) {
+        for (int lane = 0; lanes >> lane; lane++) {
+            outEvents[i + (size_t)lane] = (uint8_t)events[lane];
+        }
+    }
+}
+#endif
+
+// One physics step for every agent, same as calling `stepPlayer` for each of them.
+// `inputs` has one entry per agent, `outEvents` (can be NULL) receives each agent's `PlayerEvent` flags.
+// The step runs as a few passes over the batch, the agents of a pass don't depend on each other,
+// so the CPU works on several of them at once.
+void
+stepAgents(AgentBatch* batch, const WorldSolids* world, const PlayerInput* inputs, float delta, uint8_t* outEvents)
+{
+#if AGENT_LANES > 1
+    // The rows are read in pairs (see `gatherAgentRows`)
+    if (world->rowCount >= 2) {
+        for (size_t i = 0; i < batch->capacity; i += AGENT_LANES) {
+            checkAgentsGround(batch, world, delta, i, getAgentLanes(batch, i));
+        }
+        for (size_t i = 0; i < batch->capacity; i += AGENT_LANES) {
+            moveAgents(batch, inputs, delta, i, getAgentLanes(batch, i));
+        }
+        for (size_t i = 0; i < batch->capacity; i += AGENT_LANES) {
+            resolveAgentsContacts(batch, world, delta, i, getAgentLanes(batch, i), outEvents);
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < batch->count; i++) {
+        const PlayerStepResult step = stepPlayer(getAgent(batch, i), world, &inputs[i], delta);
+        setAgent(batch, i, &step.player);
+        if (outEvents) outEvents[i] = (uint8_t)step.events;
+    }
+}
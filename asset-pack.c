@@ -0,0 +1,208 @@
+// Decodes the game's images and sounds and writes them into an asset pack (see assets.c),
+// as a file to put next to the game, or as a C header to compile into it.
+// The sprite sheets are packed into one atlas image (see atlas.c).
+//
+// Usage: asset-pack [assets.jra]
+//        asset-pack --header [assets-data.h]
+
+#include "raylib.h" // LoadImage, LoadWave (no window needed)
+#include "raymath.h" // Vector math
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc
+#include <string.h> // strcmp
+
+#include "tilemap.c"
+#include "assets.c"
+#include "atlas.c"
+
+const char* SOUND_FILE_NAMES[] = { "jump.wav", "bump.wav", "floor.wav" };
+#define SOUND_FILE_COUNT (sizeof(SOUND_FILE_NAMES) / sizeof(SOUND_FILE_NAMES[0]))
+// The atlas, its sheets and the sounds
+#define ASSET_COUNT (1 + SPRITE_SHEET_COUNT + SOUND_FILE_COUNT)
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} AssetPackBuffer;
+
+// Space for `size` more bytes at `offset` (zeroed), growing the buffer as needed
+uint8_t*
+reserveAssetPackBytes(AssetPackBuffer* buffer, uint64_t offset, size_t size)
+{
+    const size_t end = (size_t)offset + size;
+    if (end > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (capacity < end) capacity *= 2;
+        buffer->data = (uint8_t*)realloc(buffer->data, capacity);
+        if (!buffer->data) {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(buffer->data + buffer->capacity, 0, capacity - buffer->capacity);
+        buffer->capacity = capacity;
+    }
+    if (end > buffer->size) buffer->size = end;
+    return buffer->data + offset;
+}
+
+void
+beginAssetEntry(AssetPackBuffer* buffer, AssetPackEntry* entry, const char* name, AssetType type)
+{
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, ASSET_NAME_SIZE - 1);
+    entry->type = (uint32_t)type;
+    entry->offset = alignAssetPackOffset(buffer->size);
+}
+
+// Decodes a sound file into `entry` and its data. Returns false if it can't be loaded.
+bool
+packSound(AssetPackBuffer* buffer, AssetPackEntry* entry, const char* fileName)
+{
+    beginAssetEntry(buffer, entry, fileName, ASSET_SOUND);
+    Wave wave = LoadWave(fileName);
+    if (!wave.data) return false;
+    // 16-bit PCM, what the audio device gets anyway
+    WaveFormat(&wave, (int)wave.sampleRate, 16, (int)wave.channels);
+    entry->frameCount = wave.frameCount;
+    entry->sampleRate = wave.sampleRate;
+    entry->sampleSize = wave.sampleSize;
+    entry->channels = wave.channels;
+    entry->size = (uint64_t)wave.frameCount * wave.channels * (wave.sampleSize / 8);
+    memcpy(reserveAssetPackBytes(buffer, entry->offset, (size_t)entry->size), wave.data, (size_t)entry->size);
+    UnloadWave(wave);
+    return true;
+}
+
+// Decodes the sprite sheets and packs them into the atlas: `outEntries` gets the atlas image,
+// then a sprite sheet entry per sheet. Returns false if a sheet can't be loaded.
+bool
+packSpriteAtlas(AssetPackBuffer* buffer, AssetPackEntry outEntries[1 + SPRITE_SHEET_COUNT])
+{
+    Image sheets[SPRITE_SHEET_COUNT] = { 0 };
+    bool isLoaded = true;
+    for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+        if (!SPRITE_SHEET_SOURCES[i].isFile) continue;
+        sheets[i] = LoadImage(SPRITE_SHEET_SOURCES[i].name);
+        if (!sheets[i].data) {
+            fprintf(stderr, "Can't load %s\n", SPRITE_SHEET_SOURCES[i].name);
+            isLoaded = false;
+            continue;
+        }
+        ImageFormat(&sheets[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    if (isLoaded) {
+        Rectangle rects[SPRITE_SHEET_COUNT];
+        Image atlas = buildSpriteAtlasImage(sheets, rects);
+
+        AssetPackEntry* entry = &outEntries[0];
+        beginAssetEntry(buffer, entry, ATLAS_NAME, ASSET_IMAGE);
+        entry->width = (uint32_t)atlas.width;
+        entry->height = (uint32_t)atlas.height;
+        entry->pixelFormat = (uint32_t)atlas.format;
+        entry->size = (uint64_t)GetPixelDataSize(atlas.width, atlas.height, atlas.format);
+        memcpy(reserveAssetPackBytes(buffer, entry->offset, (size_t)entry->size), atlas.data, (size_t)entry->size);
+        UnloadImage(atlas);
+
+        for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+            entry = &outEntries[1 + i];
+            beginAssetEntry(buffer, entry, SPRITE_SHEET_SOURCES[i].name, ASSET_SPRITE_SHEET);
+            entry->offset = 0;
+            entry->x = (uint32_t)rects[i].x;
+            entry->y = (uint32_t)rects[i].y;
+            entry->width = (uint32_t)rects[i].width;
+            entry->height = (uint32_t)rects[i].height;
+        }
+    }
+
+    for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+        if (sheets[i].data) UnloadImage(sheets[i]);
+    }
+    return isLoaded;
+}
+
+// The pack as an array of 64-bit words (so the entries are aligned), in native byte order like the file
+bool
+writeAssetPackHeader(const char* fileName, AssetPackBuffer* buffer)
+{
+    FILE* file = fopen(fileName, "w");
+    if (!file) return false;
+    const size_t size = buffer->size;
+    const size_t wordCount = (size + 7) / 8;
+    reserveAssetPackBytes(buffer, 0, wordCount * 8); // Zero padding
+    buffer->size = size;
+    fprintf(file, "// Generated by asset-pack, don't edit\n\n");
+    fprintf(file, "const size_t embeddedAssetPackSize = %zu;\n", size);
+    fprintf(file, "const uint64_t embeddedAssetPack[%zu] = {\n", wordCount);
+    for (size_t i = 0; i < wordCount; i++) {
+        uint64_t word;
+        memcpy(&word, buffer->data + i * 8, 8);
+        fprintf(file, "0x%016llxull,%s", (unsigned long long)word, (i % 4 == 3) ? "\n" : "");
+    }
+    fprintf(file, "\n};\n");
+    const bool isOk = !ferror(file);
+    return (fclose(file) == 0) && isOk;
+}
+
+int
+main(int argc, const char** argv)
+{
+    const bool isHeader = argc > 1 && strcmp(argv[1], "--header") == 0;
+    if (isHeader) {
+        argc--;
+        argv++;
+    }
+    if (argc > 2 || (argc == 2 && strncmp(argv[1], "--", 2) == 0)) {
+        fprintf(stderr, "Usage: %s [%s]\n       %s --header [%s]\n", argv[0], ASSET_PACK_FILE_NAME, argv[0], ASSET_PACK_HEADER_NAME);
+        return 1;
+    }
+    const char* fileName = argc == 2 ? argv[1] : (isHeader ? ASSET_PACK_HEADER_NAME : ASSET_PACK_FILE_NAME);
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    AssetPackBuffer buffer = { 0 };
+    const uint64_t entriesOffset = sizeof(AssetPackHeader);
+    reserveAssetPackBytes(&buffer, 0, entriesOffset + ASSET_COUNT * sizeof(AssetPackEntry));
+
+    AssetPackEntry entries[ASSET_COUNT];
+    if (!packSpriteAtlas(&buffer, entries)) return 1;
+    for (size_t i = 0; i < SOUND_FILE_COUNT; i++) {
+        if (!packSound(&buffer, &entries[1 + SPRITE_SHEET_COUNT + i], SOUND_FILE_NAMES[i])) {
+            fprintf(stderr, "Can't load %s\n", SOUND_FILE_NAMES[i]);
+            return 1;
+        }
+    }
+    for (size_t i = 0; i < ASSET_COUNT; i++) {
+        const AssetPackEntry* entry = &entries[i];
+        if (entry->type == ASSET_SPRITE_SHEET) {
+            printf("%-12s at %u,%u in %s\n", entry->name, entry->x, entry->y, ATLAS_NAME);
+        } else {
+            printf("%-12s %8llu bytes\n", entry->name, (unsigned long long)entry->size);
+        }
+    }
+    memcpy(buffer.data + entriesOffset, entries, sizeof(entries));
+
+    AssetPackHeader header = { { 0 }, ASSET_PACK_VERSION, (uint32_t)ASSET_COUNT, 0 };
+    memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+    memcpy(buffer.data, &header, sizeof(header));
+
+    bool isWritten = false;
+    if (isHeader) {
+        isWritten = writeAssetPackHeader(fileName, &buffer);
+    } else {
+        FILE* file = fopen(fileName, "wb");
+        isWritten = file && fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+        if (file) isWritten = (fclose(file) == 0) && isWritten;
+    }
+    if (!isWritten) {
+        fprintf(stderr, "%s: can't write\n", fileName);
+        return 1;
+    }
+    printf("Wrote %zu bytes to %s\n", buffer.size, fileName);
+
+    free(buffer.data);
+    return 0;
+}
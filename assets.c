@@ -0,0 +1,155 @@
+
+// Asset pack (*.jra): the game's images and sounds, already decoded, in one blob.
+//
+// Layout (native byte order):
+//   AssetPackHeader
+//   AssetPackEntry entries[assetCount]
+//   data of each entry at `entry.offset`, aligned to `ASSET_PACK_ALIGNMENT`
+//
+// Images are raw pixels in a raylib pixel format, sounds raw PCM frames, so loading them is
+// a copy to the GPU or the audio device. The sprite sheets are packed into one atlas image (atlas.c). `asset-pack` makes the pack from the source files;
+// it's either compiled into the game (`EMBED_ASSETS`, see `ASSET_PACK_HEADER_NAME`) or read
+// from next to the executable.
+
+#define ASSET_PACK_MAGIC "JRAP"
+#define ASSET_PACK_VERSION 2
+#define ASSET_PACK_ALIGNMENT 64
+#define ASSET_PACK_MAX_ASSETS 64
+#define ASSET_NAME_SIZE 32
+#define ASSET_PACK_FILE_NAME "assets.jra"
+// Generated C header with the pack as an array (`embeddedAssetPack`)
+#define ASSET_PACK_HEADER_NAME "assets-data.h"
+
+typedef enum {
+    ASSET_IMAGE = 1,
+    ASSET_SOUND = 2,
+    ASSET_SPRITE_SHEET = 3, // No data, a part of an image (the sprite atlas)
+} AssetType;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t assetCount;
+    uint32_t reserved;
+} AssetPackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_SIZE]; // Source file name, e.g. "player.png"
+    uint32_t type; // `AssetType`
+    // Images and sprite sheets
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixelFormat; // raylib `PixelFormat`
+    uint32_t x; // Sprite sheets: where in the image
+    uint32_t y;
+    // Sounds
+    uint32_t frameCount;
+    uint32_t sampleRate;
+    uint32_t sampleSize; // Bits
+    uint32_t channels;
+    uint64_t offset;
+    uint64_t size;
+} AssetPackEntry;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    uint8_t* ownedData; // Read from a file, freed by `closeAssetPack`
+    const AssetPackHeader* header;
+    const AssetPackEntry* entries;
+} AssetPack;
+
+uint64_t
+alignAssetPackOffset(uint64_t offset)
+{
+    return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+// Use a pack that's already in memory. Returns false (with a message on stderr) if it's broken.
+bool
+openAssetPack(AssetPack* pack, const uint8_t* data, size_t size, const char* name)
+{
+    memset(pack, 0, sizeof(*pack));
+
+    const AssetPackHeader* header = (const AssetPackHeader*)data;
+    if (size < sizeof(AssetPackHeader) || memcmp(header->magic, ASSET_PACK_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not an asset pack\n", name);
+        return false;
+    }
+    if (header->version != ASSET_PACK_VERSION || header->assetCount > ASSET_PACK_MAX_ASSETS ||
+        size < sizeof(AssetPackHeader) + header->assetCount * sizeof(AssetPackEntry)) {
+        fprintf(stderr, "%s: unsupported asset pack version %u\n", name, header->version);
+        return false;
+    }
+
+    const AssetPackEntry* entries = (const AssetPackEntry*)(data + sizeof(AssetPackHeader));
+    for (uint32_t i = 0; i < header->assetCount; i++) {
+        if (entries[i].offset > size || entries[i].size > size - entries[i].offset ||
+            memchr(entries[i].name, '\0', ASSET_NAME_SIZE) == NULL) {
+            fprintf(stderr, "%s: broken entry %u\n", name, i);
+            return false;
+        }
+    }
+
+    pack->data = data;
+    pack->size = size;
+    pack->header = header;
+    pack->entries = entries;
+    return true;
+}
+
+// Read a whole pack file, one read and no decoding
+bool
+loadAssetPackFile(AssetPack* pack, const char* fileName)
+{
+    memset(pack, 0, sizeof(*pack));
+
+    FILE* file = fopen(fileName, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize <= 0) {
+        fclose(file);
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*)malloc((size_t)fileSize);
+    if (!data) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    const bool isRead = fread(data, 1, (size_t)fileSize, file) == (size_t)fileSize;
+    fclose(file);
+    if (!isRead || !openAssetPack(pack, data, (size_t)fileSize, fileName)) {
+        free(data);
+        return false;
+    }
+    pack->ownedData = data;
+    return true;
+}
+
+void
+closeAssetPack(AssetPack* pack)
+{
+    free(pack->ownedData);
+    memset(pack, 0, sizeof(*pack));
+}
+
+// NULL when the pack has no asset of that name and type
+const AssetPackEntry*
+findAsset(const AssetPack* pack, const char* name, AssetType type)
+{
+    if (!pack->header) return NULL;
+    for (uint32_t i = 0; i < pack->header->assetCount; i++) {
+        const AssetPackEntry* entry = &pack->entries[i];
+        if (entry->type == (uint32_t)type && strcmp(entry->name, name) == 0) return entry;
+    }
+    return NULL;
+}
+
+const void*
+getAssetData(const AssetPack* pack, const AssetPackEntry* entry)
+{
+    return pack->data + entry->offset;
+}
@@ -0,0 +1,213 @@
+
+// Sprite atlas: every sprite sheet in one texture, so drawing sprites from different sheets
+// doesn't switch textures and raylib keeps them in one batch (one draw call).
+//
+// The sheets are packed into shelves, tallest first. `asset-pack` packs them when building the
+// asset pack (an "atlas" image and a sprite sheet entry per sheet with its place in it),
+// otherwise the game packs the image files at startup. Either way a table of every sprite's
+// rectangle is made when loading, so drawing a sprite is a lookup.
+//
+// The atlas also has a white block, used as the shapes texture (`SetShapesTexture`),
+// so lines and rectangles drawn between sprites stay in the same batch too.
+
+#define ATLAS_NAME "atlas"
+#define ATLAS_WHITE_PIXELS 4
+#define ATLAS_MAX_SPRITES 256
+
+typedef enum {
+  SPRITE_SHEET_PLAYER,
+  SPRITE_SHEET_TILEMAP,
+  SPRITE_SHEET_WHITE, // `ATLAS_WHITE_PIXELS` square of white
+  SPRITE_SHEET_COUNT,
+} SpriteSheet;
+
+typedef struct {
+  const char* name; // Image file name, also the name of the sheet in the asset pack
+  int spriteSize; // Sprites are squares
+  bool isFile;
+} SpriteSheetSource;
+
+const SpriteSheetSource SPRITE_SHEET_SOURCES[SPRITE_SHEET_COUNT] = {
+  { "player.png", 16, true },
+  { "tilemap.png", TILE_PIXELS, true },
+  { "white", ATLAS_WHITE_PIXELS, false },
+};
+
+typedef struct {
+  Texture texture;
+  Rectangle sheets[SPRITE_SHEET_COUNT]; // Where each sheet is in the atlas
+  Rectangle sprites[ATLAS_MAX_SPRITES];
+  int sheetFirstSprite[SPRITE_SHEET_COUNT];
+  int sheetColumns[SPRITE_SHEET_COUNT];
+} SpriteAtlas;
+
+SpriteAtlas spriteAtlas = { 0 };
+
+int
+getAtlasSize(int minSize)
+{
+  int size = 64;
+  while (size < minSize) size *= 2;
+  return size;
+}
+
+// Places the sheets of the given sizes (`width`, `height` of `outRects`) into shelves, tallest first.
+// Returns the size of the atlas image.
+Vector2
+layoutSpriteAtlas(Rectangle outRects[SPRITE_SHEET_COUNT])
+{
+  int order[SPRITE_SHEET_COUNT];
+  int maxWidth = 0;
+  for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+    order[i] = i;
+    maxWidth = (int)fmaxf((float)maxWidth, outRects[i].width);
+  }
+  for (int i = 1; i < SPRITE_SHEET_COUNT; i++) {
+    for (int j = i; j > 0 && outRects[order[j]].height > outRects[order[j - 1]].height; j--) {
+      const int swap = order[j];
+      order[j] = order[j - 1];
+      order[j - 1] = swap;
+    }
+  }
+
+  const int width = getAtlasSize(maxWidth);
+  int x = 0;
+  int shelfY = 0;
+  int shelfHeight = 0;
+  for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+    Rectangle* rect = &outRects[order[i]];
+    if (x + (int)rect->width > width) {
+      shelfY += shelfHeight;
+      x = 0;
+      shelfHeight = 0;
+    }
+    rect->x = (float)x;
+    rect->y = (float)shelfY;
+    x += (int)rect->width;
+    shelfHeight = (int)fmaxf((float)shelfHeight, rect->height);
+  }
+  return (Vector2){ (float)width, (float)getAtlasSize(shelfY + shelfHeight) };
+}
+
+// Packs the sheet images (RGBA8, the white block is made here) into one atlas image
+Image
+buildSpriteAtlasImage(const Image files[SPRITE_SHEET_COUNT], Rectangle outRects[SPRITE_SHEET_COUNT])
+{
+  Image sheets[SPRITE_SHEET_COUNT];
+  memcpy(sheets, files, sizeof(sheets));
+  sheets[SPRITE_SHEET_WHITE] = GenImageColor(ATLAS_WHITE_PIXELS, ATLAS_WHITE_PIXELS, WHITE);
+  for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+    outRects[i] = (Rectangle){ 0, 0, (float)sheets[i].width, (float)sheets[i].height };
+  }
+  const Vector2 size = layoutSpriteAtlas(outRects);
+
+  Image atlas = GenImageColor((int)size.x, (int)size.y, BLANK);
+  for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+    // Copy the pixels as they are, no blending
+    for (int y = 0; y < sheets[i].height; y++) {
+      memcpy((uint8_t*)atlas.data + (((int)outRects[i].y + y) * atlas.width + (int)outRects[i].x) * 4,
+             (const uint8_t*)sheets[i].data + y * sheets[i].width * 4,
+             (size_t)sheets[i].width * 4);
+    }
+  }
+  UnloadImage(sheets[SPRITE_SHEET_WHITE]);
+  return atlas;
+}
+
+// Every sprite's rectangle, from where the sheets are
+void
+buildAtlasSpriteTable(void)
+{
+  int count = 0;
+  for (int sheet = 0; sheet < SPRITE_SHEET_COUNT; sheet++) {
+    const Rectangle rect = spriteAtlas.sheets[sheet];
+    const int size = SPRITE_SHEET_SOURCES[sheet].spriteSize;
+    const int columns = (int)rect.width / size;
+    const int rows = (int)rect.height / size;
+    spriteAtlas.sheetFirstSprite[sheet] = count;
+    spriteAtlas.sheetColumns[sheet] = columns;
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < columns && count < ATLAS_MAX_SPRITES; x++) {
+        spriteAtlas.sprites[count++] = (Rectangle){ rect.x + (float)(x * size), rect.y + (float)(y * size), (float)size, (float)size };
+      }
+    }
+  }
+}
+
+// From the asset pack when it has the atlas, otherwise packed from the image files
+void
+loadSpriteAtlas(const AssetPack* pack)
+{
+  const AssetPackEntry* atlasEntry = findAsset(pack, ATLAS_NAME, ASSET_IMAGE);
+  bool isPacked = atlasEntry != NULL;
+  for (int i = 0; i < SPRITE_SHEET_COUNT && isPacked; i++) {
+    const AssetPackEntry* entry = findAsset(pack, SPRITE_SHEET_SOURCES[i].name, ASSET_SPRITE_SHEET);
+    if (!entry) {
+      isPacked = false;
+      break;
+    }
+    spriteAtlas.sheets[i] = (Rectangle){ (float)entry->x, (float)entry->y, (float)entry->width, (float)entry->height };
+  }
+
+  if (isPacked) {
+    Image image = { 0 };
+    image.data = (void*)getAssetData(pack, atlasEntry); // Only read
+    image.width = (int)atlasEntry->width;
+    image.height = (int)atlasEntry->height;
+    image.mipmaps = 1;
+    image.format = (int)atlasEntry->pixelFormat;
+    spriteAtlas.texture = LoadTextureFromImage(image);
+  } else {
+    Image sheets[SPRITE_SHEET_COUNT] = { 0 };
+    for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+      if (!SPRITE_SHEET_SOURCES[i].isFile) continue;
+      sheets[i] = LoadImage(TextFormat("%s%s", GetApplicationDirectory(), SPRITE_SHEET_SOURCES[i].name));
+      ImageFormat(&sheets[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    Image atlas = buildSpriteAtlasImage(sheets, spriteAtlas.sheets);
+    spriteAtlas.texture = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+    for (int i = 0; i < SPRITE_SHEET_COUNT; i++) {
+      if (SPRITE_SHEET_SOURCES[i].isFile) UnloadImage(sheets[i]);
+    }
+  }
+
+  buildAtlasSpriteTable();
+  // Inside the white block, so texture coordinates at its edges don't pick up the neighbors
+  const Rectangle white = spriteAtlas.sheets[SPRITE_SHEET_WHITE];
+  SetShapesTexture(spriteAtlas.texture, (Rectangle){ white.x + 1.0f, white.y + 1.0f, white.width - 2.0f, white.height - 2.0f });
+}
+
+void
+unloadSpriteAtlas(void)
+{
+  SetShapesTexture((Texture){ 0 }, (Rectangle){ 0 });
+  UnloadTexture(spriteAtlas.texture);
+}
+
+// Sprites outside of the sheet (e.g. from a `tilemap.autotile` for a bigger tileset) are the first sprite
+Rectangle
+getAtlasSprite(SpriteSheet sheet, int spriteX, int spriteY)
+{
+  const int first = spriteAtlas.sheetFirstSprite[sheet];
+  const int end = sheet + 1 < SPRITE_SHEET_COUNT ? spriteAtlas.sheetFirstSprite[sheet + 1] : ATLAS_MAX_SPRITES;
+  const int index = first + spriteY * spriteAtlas.sheetColumns[sheet] + spriteX;
+  if (spriteX >= spriteAtlas.sheetColumns[sheet] || index >= end) return spriteAtlas.sprites[first];
+  return spriteAtlas.sprites[index];
+}
+
+// Draw one sprite, a negative `scale` flips it
+void
+drawAtlasSpriteTinted(SpriteSheet sheet, int spriteX, int spriteY, const Vector2 position, const Vector2 scale, Color tint)
+{
+  Rectangle source = getAtlasSprite(sheet, spriteX, spriteY);
+  source.width *= scale.x;
+  source.height *= scale.y;
+  DrawTextureRec(spriteAtlas.texture, source, position, tint);
+}
+
+void
+drawAtlasSprite(SpriteSheet sheet, int spriteX, int spriteY, const Vector2 position, const Vector2 scale)
+{
+  drawAtlasSpriteTinted(sheet, spriteX, spriteY, position, scale, WHITE);
+}
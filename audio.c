@@ -0,0 +1,102 @@
+
+// Sounds of the queued physics events (see events.c).
+//
+// Each event type has a few aliases of its sound (they share the sample data), so a sound can
+// start again while the previous one is still playing. Events of the same type are merged
+// within a frame, and a sound doesn't restart sooner than `GAME_SOUND_MIN_INTERVAL`: sliding
+// along a wall bumps on many physics steps, but should sound like one bump.
+
+#define GAME_SOUND_ALIAS_COUNT 4
+#define GAME_SOUND_MIN_INTERVAL 0.06 // Seconds
+
+typedef struct {
+  Sound sound;
+  Sound aliases[GAME_SOUND_ALIAS_COUNT];
+  int nextAlias;
+  double lastPlayed; // `GetTime` seconds
+} GameSound;
+
+GameSound gameSounds[GAME_EVENT_TYPE_COUNT];
+
+void
+loadGameSound(GameEventType type, Sound sound)
+{
+  GameSound* gameSound = &gameSounds[type];
+  gameSound->sound = sound;
+  for (int i = 0; i < GAME_SOUND_ALIAS_COUNT; i++) {
+    gameSound->aliases[i] = LoadSoundAlias(sound);
+  }
+  gameSound->nextAlias = 0;
+  gameSound->lastPlayed = -GAME_SOUND_MIN_INTERVAL;
+}
+
+// Sound of PCM frames from the asset pack, or loaded (and decoded) from the file next to the game when the pack doesn't have it
+Sound
+loadAssetSound(const AssetPack* pack, const char* fileName)
+{
+  const AssetPackEntry* entry = findAsset(pack, fileName, ASSET_SOUND);
+  if (!entry) return LoadSound(TextFormat("%s%s", GetApplicationDirectory(), fileName));
+
+  Wave wave = { 0 };
+  wave.frameCount = entry->frameCount;
+  wave.sampleRate = entry->sampleRate;
+  wave.sampleSize = entry->sampleSize;
+  wave.channels = entry->channels;
+  wave.data = (void*)getAssetData(pack, entry); // Copied by `LoadSoundFromWave`
+  return LoadSoundFromWave(wave);
+}
+
+void
+loadGameSounds(const AssetPack* pack)
+{
+  loadGameSound(GAME_EVENT_JUMP, loadAssetSound(pack, "jump.wav"));
+  loadGameSound(GAME_EVENT_LAND, loadAssetSound(pack, "floor.wav"));
+  loadGameSound(GAME_EVENT_BUMP, loadAssetSound(pack, "bump.wav"));
+}
+
+void
+unloadGameSounds(void)
+{
+  for (int type = 0; type < GAME_EVENT_TYPE_COUNT; type++) {
+    for (int i = 0; i < GAME_SOUND_ALIAS_COUNT; i++) {
+      UnloadSoundAlias(gameSounds[type].aliases[i]);
+    }
+    UnloadSound(gameSounds[type].sound);
+  }
+}
+
+// A free alias, or the one that started playing the longest time ago
+void
+playGameSound(GameSound* gameSound)
+{
+  int alias = gameSound->nextAlias;
+  for (int i = 0; i < GAME_SOUND_ALIAS_COUNT; i++) {
+    const int candidate = (gameSound->nextAlias + i) % GAME_SOUND_ALIAS_COUNT;
+    if (!IsSoundPlaying(gameSound->aliases[candidate])) {
+      alias = candidate;
+      break;
+    }
+  }
+  PlaySound(gameSound->aliases[alias]);
+  gameSound->nextAlias = (alias + 1) % GAME_SOUND_ALIAS_COUNT;
+}
+
+// Play the sounds of the frame's events and empty the queue
+void
+dispatchGameEvents(GameEventQueue* queue)
+{
+  bool isTypeQueued[GAME_EVENT_TYPE_COUNT] = { 0 };
+  for (int i = 0; i < queue->count; i++) {
+    isTypeQueued[queue->events[i].type] = true;
+  }
+
+  const double now = GetTime();
+  for (int type = 0; type < GAME_EVENT_TYPE_COUNT; type++) {
+    GameSound* gameSound = &gameSounds[type];
+    if (!isTypeQueued[type] || now - gameSound->lastPlayed < GAME_SOUND_MIN_INTERVAL) continue;
+    playGameSound(gameSound);
+    gameSound->lastPlayed = now;
+  }
+
+  clearGameEvents(queue);
+}
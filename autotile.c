@@ -0,0 +1,176 @@
+
+// Autotiling: picks the tileset sprite for a solid tile based on which of its 8 neighbors are solid.
+//
+// The neighbors are packed into an 8-bit mask (see `AUTOTILE_N`...), and the mask indexes
+// a 256-entry table of sprite coordinates. The table starts with the sprites of the
+// default tilemap.png, and can be overridden from a text file (see `loadAutotileTable`),
+// so a bigger tileset (e.g. a full 47-tile "blob" set) only needs a new table, not new code.
+
+#define AUTOTILE_N  (1 << 0)
+#define AUTOTILE_NE (1 << 1)
+#define AUTOTILE_E  (1 << 2)
+#define AUTOTILE_SE (1 << 3)
+#define AUTOTILE_S  (1 << 4)
+#define AUTOTILE_SW (1 << 5)
+#define AUTOTILE_W  (1 << 6)
+#define AUTOTILE_NW (1 << 7)
+
+#define AUTOTILE_TABLE_SIZE 256
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+} AutotileSprite;
+
+AutotileSprite autotileTable[AUTOTILE_TABLE_SIZE];
+
+// A corner only matters when both edges next to it are solid, otherwise it's hidden.
+// This folds the 256 masks into the 47 tiles of a blob tileset.
+uint8_t
+autotileCanonicalMask(uint8_t mask)
+{
+    const bool n = mask & AUTOTILE_N;
+    const bool e = mask & AUTOTILE_E;
+    const bool s = mask & AUTOTILE_S;
+    const bool w = mask & AUTOTILE_W;
+    if (!(n && e)) mask &= ~AUTOTILE_NE;
+    if (!(s && e)) mask &= ~AUTOTILE_SE;
+    if (!(s && w)) mask &= ~AUTOTILE_SW;
+    if (!(n && w)) mask &= ~AUTOTILE_NW;
+    return mask;
+}
+
+// Sprite for a mask in the default tilemap.png.
+// This logic is bit of a hack... but it only runs when building the table.
+AutotileSprite
+autotileDefaultSprite(uint8_t mask)
+{
+    const bool top = mask & AUTOTILE_N;
+    const bool bottom = mask & AUTOTILE_S;
+    const bool right = mask & AUTOTILE_E;
+    const bool left = mask & AUTOTILE_W;
+    const bool topRight = mask & AUTOTILE_NE;
+    const bool bottomRight = mask & AUTOTILE_SE;
+    const bool topLeft = mask & AUTOTILE_NW;
+    const bool bottomLeft = mask & AUTOTILE_SW;
+
+    int spriteX = 1;
+    int spriteY = 1;
+    if (top) spriteY += 1;
+    if (bottom) spriteY -= 1;
+    if (right) spriteX -= 1;
+    if (left) spriteX += 1;
+
+    if (!top && !bottom && !right && !left) {
+        spriteX = 3;
+        spriteY = 3;
+    }
+
+    if (!left && !right && spriteX == 1) spriteX = 3;
+    if (!top && !bottom && spriteY == 1) spriteY = 3;
+
+    if (spriteX == 1 && spriteY == 1) {
+        if (!topRight && bottomRight && topLeft && bottomLeft) {
+            spriteX = 4;
+            spriteY = 2;
+        }
+
+        if (topRight && !bottomRight && topLeft && bottomLeft) {
+            spriteX = 4;
+            spriteY = 0;
+        }
+
+        if (topRight && bottomRight && !topLeft && bottomLeft) {
+            spriteX = 6;
+            spriteY = 2;
+        }
+
+        if (topRight && bottomRight && topLeft && !bottomLeft) {
+            spriteX = 6;
+            spriteY = 0;
+        }
+    }
+
+    AutotileSprite sprite = { (uint8_t)spriteX, (uint8_t)spriteY };
+    return sprite;
+}
+
+void
+initAutotileTable(void)
+{
+    for (int mask = 0; mask < AUTOTILE_TABLE_SIZE; mask++) {
+        autotileTable[mask] = autotileDefaultSprite((uint8_t)mask);
+    }
+}
+
+// Override table entries from a text file, one entry per line: "<mask> <spriteX> <spriteY>".
+// The mask is a blob mask (corners only count next to two solid edges, see `autotileCanonicalMask`),
+// and the entry is used for every neighbor combination that folds into it.
+// Lines starting with '#' are comments. Returns false when the file can't be opened.
+bool
+loadAutotileTable(const char* fileName)
+{
+    FILE* file = fopen(fileName, "r");
+    if (!file) return false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+
+        int mask = 0;
+        int spriteX = 0;
+        int spriteY = 0;
+        if (sscanf(line, "%i %i %i", &mask, &spriteX, &spriteY) != 3) continue;
+        if (mask < 0 || mask >= AUTOTILE_TABLE_SIZE || spriteX < 0 || spriteY < 0) continue;
+
+        const AutotileSprite sprite = { (uint8_t)spriteX, (uint8_t)spriteY };
+        for (int other = 0; other < AUTOTILE_TABLE_SIZE; other++) {
+            if (autotileCanonicalMask((uint8_t)other) == mask) autotileTable[other] = sprite;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Row of the collision layer with a solid column on both sides:
+// bit 0 is the column left of the grid, bit `x + 1` is column `x`.
+// Rows outside of the grid are all solid.
+uint32_t
+autotilePaddedRow(const TilemapSolids* solids, int y)
+{
+    const uint32_t allSolid = (1u << (TILEMAP_SIZE_X + 2)) - 1;
+    if (y < 0 || y >= TILEMAP_SIZE_Y) return allSolid;
+    return ((uint32_t)(*solids)[y] << 1) | 1u | (1u << (TILEMAP_SIZE_X + 1));
+}
+
+// Neighbor masks of every tile in row `y`.
+// The three rows around `y` are shifted so that bit `x` of each word is one
+// neighbor of tile `x`, then the bits are gathered into the masks.
+void
+autotileRowMasks(const TilemapSolids* solids, int y, uint8_t outMasks[TILEMAP_SIZE_X])
+{
+    const uint32_t above = autotilePaddedRow(solids, y - 1);
+    const uint32_t row = autotilePaddedRow(solids, y);
+    const uint32_t below = autotilePaddedRow(solids, y + 1);
+
+    const uint32_t n = above >> 1;
+    const uint32_t ne = above >> 2;
+    const uint32_t e = row >> 2;
+    const uint32_t se = below >> 2;
+    const uint32_t s = below >> 1;
+    const uint32_t sw = below;
+    const uint32_t w = row;
+    const uint32_t nw = above;
+
+    for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+        outMasks[x] = (uint8_t)(((n >> x) & 1)
+                                | ((ne >> x) & 1) << 1
+                                | ((e >> x) & 1) << 2
+                                | ((se >> x) & 1) << 3
+                                | ((s >> x) & 1) << 4
+                                | ((sw >> x) & 1) << 5
+                                | ((w >> x) & 1) << 6
+                                | ((nw >> x) & 1) << 7);
+    }
+}
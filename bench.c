@@ -0,0 +1,562 @@
+// Microbenchmarks of the collision, tilemap and autotile code that the game and the simulations run all the time.
+//
+// Every benchmark runs on random inputs and on worst-case inputs (the slowest path through
+// the code). The iteration count is picked so a repetition takes about `BENCH_TARGET_SECONDS`,
+// then after a few warmup repetitions every repetition is timed on its own, and
+// min/median/mean/stddev/max nanoseconds per call are reported.
+//
+// Usage: bench [--reps N] [--filter text] [--json [file.json]]
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h" // Vector math (header-only)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <stdlib.h> // qsort
+#include <string.h> // strcmp, strstr
+#include <time.h> // clock_gettime
+#if defined(_WIN32)
+#include <windows.h> // QueryPerformanceCounter
+#endif
+
+#include "globals.c"
+#include "tilemap.c"
+#include "collision.c"
+#include "player.c"
+#include "autotile.c"
+
+#define BENCH_INPUT_COUNT 4096 // Power of two
+#define BENCH_WARMUP_REPS 3
+#define BENCH_DEFAULT_REPS 15
+#define BENCH_TARGET_SECONDS 0.01
+#define BENCH_BIG_LEVEL_SCREENS 1024
+
+typedef struct {
+    Vector2 center;
+    Vector2 size;
+} BenchBox;
+
+typedef struct {
+    Player player;
+    PlayerInput input;
+    float delta;
+} BenchPlayer;
+
+typedef struct {
+    const char* name;
+    const char* inputs; // "random", "worst", or "builtin" for the built-in level
+    uint64_t (*run)(size_t iterations); // Returns something that depends on the results, so nothing is optimized out
+} Benchmark;
+
+typedef struct {
+    const Benchmark* benchmark;
+    size_t iterations;
+    int reps;
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double max;
+} BenchResult;
+
+// Inputs, made once before any benchmark runs
+WorldSolids benchWorld;
+BenchBox benchRandomBoxes[BENCH_INPUT_COUNT];
+BenchBox benchNegativeBoxes[BENCH_INPUT_COUNT];
+BenchBox benchTouchingBoxes[BENCH_INPUT_COUNT];
+BenchBox benchCornerBoxes[BENCH_INPUT_COUNT];
+BenchPlayer benchRandomPlayers[BENCH_INPUT_COUNT];
+BenchPlayer benchFastPlayers[BENCH_INPUT_COUNT];
+TileRay benchRandomRays[BENCH_INPUT_COUNT];
+TileRay benchLongRays[BENCH_INPUT_COUNT];
+TileRay benchBoxTraces[BENCH_INPUT_COUNT];
+TileRay benchWallTraces[BENCH_INPUT_COUNT];
+TilemapSolids benchRandomSolids[64];
+TilemapSolids benchCheckerSolids[64];
+Tilemap benchRandomTilemaps[64];
+Tilemap* benchBigTilemaps;
+TilemapSolids* benchBigSolids;
+
+volatile uint64_t benchSink;
+
+double
+getBenchSeconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+uint32_t benchSeed = 12345u;
+
+float
+benchRandom(float min, float max)
+{
+    benchSeed = benchSeed * 1664525u + 1013904223u;
+    return min + (max - min) * (float)(benchSeed >> 8) / (float)(1u << 24);
+}
+
+// Uses the bits of a float, so the result depends on every bit of the value
+uint64_t
+benchFloatBits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+// Random empty tile that has a full tile right next to it, in world coordinates
+void
+findBenchWallTile(int* outX, int* outY)
+{
+    for (;;) {
+        const int x = (int)benchRandom(0.0f, (float)TILEMAP_SIZE_X);
+        const int y = benchWorld.topY + (int)benchRandom(0.0f, (float)benchWorld.rowCount);
+        if (worldSolidsIsTileFull(&benchWorld, x, y)) continue;
+        if (worldSolidsIsTileFull(&benchWorld, x - 1, y) || worldSolidsIsTileFull(&benchWorld, x + 1, y) ||
+            worldSolidsIsTileFull(&benchWorld, x, y - 1) || worldSolidsIsTileFull(&benchWorld, x, y + 1)) {
+            *outX = x;
+            *outY = y;
+            return;
+        }
+    }
+}
+
+// Random full tile that's the only full one in the `size` x `size` tiles ending with it (it's their
+// bottom right), in world coordinates. Returns false when the level doesn't have one.
+bool
+findBenchLastFullTile(int size, int* outX, int* outY)
+{
+    for (int attempt = 0; attempt < 100000; attempt++) {
+        const int x = (int)benchRandom((float)(size - 1), (float)TILEMAP_SIZE_X);
+        const int y = benchWorld.topY + (int)benchRandom((float)(size - 1), (float)benchWorld.rowCount);
+        if (!worldSolidsIsTileFull(&benchWorld, x, y)) continue;
+        int fullCount = 0;
+        for (int tileY = y - size + 1; tileY <= y; tileY++) {
+            for (int tileX = x - size + 1; tileX <= x; tileX++) {
+                fullCount += worldSolidsIsTileFull(&benchWorld, tileX, tileY);
+            }
+        }
+        if (fullCount == 1) {
+            *outX = x;
+            *outY = y;
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+prepareBenchInputs(void)
+{
+    mainTilemap = createTilemap(numOfLevels, &mainTilemapSolids);
+    buildMainTilemapDistances();
+    benchWorld = getWorldSolids();
+    const float top = (float)benchWorld.topY;
+    const float bottom = (float)(benchWorld.topY + benchWorld.rowCount);
+
+    for (int i = 0; i < BENCH_INPUT_COUNT; i++) {
+        // Anywhere in the level
+        benchRandomBoxes[i].center = (Vector2){ benchRandom(0.0f, (float)TILEMAP_SIZE_X), benchRandom(top, bottom) };
+        benchRandomBoxes[i].size = PLAYER_SIZE;
+
+        // Left of and above the level, where rounding down differs from truncating
+        benchNegativeBoxes[i].center = (Vector2){ benchRandom(-8.0f, 0.0f), benchRandom(top - 8.0f, top) };
+        benchNegativeBoxes[i].size = PLAYER_SIZE;
+
+        // A box over 3x3 (or 2x2) tiles where the only full one is the bottom right: the row masks
+        // can't rule it out, and it's the last tile the loop (x outer, y inner) looks at.
+        // Any full tile in the range touches the box, so there's no worse input that doesn't collide.
+        int x = 0;
+        int y = 0;
+        int rangeSize = 3;
+        while (!findBenchLastFullTile(rangeSize, &x, &y)) rangeSize--;
+        const float halfRange = 0.5f * (float)rangeSize;
+        benchTouchingBoxes[i].center = (Vector2){ (float)(x + 1) - halfRange, (float)(y + 1) - halfRange };
+        benchTouchingBoxes[i].size = (Vector2){ halfRange - 0.25f, halfRange - 0.25f };
+
+        // The player box pushed into a corner of a wall, so it's clipped on both axes
+        findBenchWallTile(&x, &y);
+        benchCornerBoxes[i].center = (Vector2){ (float)x + benchRandom(0.2f, 0.35f), (float)y + benchRandom(0.2f, 0.35f) };
+        if (worldSolidsIsTileFull(&benchWorld, x + 1, y)) benchCornerBoxes[i].center.x += 0.45f;
+        if (worldSolidsIsTileFull(&benchWorld, x, y + 1)) benchCornerBoxes[i].center.y += 0.45f;
+        benchCornerBoxes[i].size = PLAYER_SIZE;
+
+        BenchPlayer* p = &benchRandomPlayers[i];
+        p->player = player;
+        p->player.position = benchRandomBoxes[i].center;
+        p->player.velocity = (Vector2){ benchRandom(-10.0f, 10.0f), benchRandom(-15.0f, 15.0f) };
+        p->player.jumpHoldTime = benchRandom(0.0f, 1.0f);
+        p->player.isOnGround = benchRandom(0.0f, 1.0f) < 0.5f;
+        p->input.isJumpDown = benchRandom(0.0f, 1.0f) < 0.5f;
+        p->input.isJumpReleased = !p->input.isJumpDown && benchRandom(0.0f, 1.0f) < 0.2f;
+        p->input.isRightDown = benchRandom(0.0f, 1.0f) < 0.3f;
+        p->input.isLeftDown = !p->input.isRightDown && benchRandom(0.0f, 1.0f) < 0.3f;
+        p->delta = PHYSICS_DELTA;
+
+        // Top speed with a long frame, so every step has to sweep for walls
+        BenchPlayer* fast = &benchFastPlayers[i];
+        *fast = *p;
+        const float angle = benchRandom(0.0f, 2.0f * 3.14159265f);
+        fast->player.velocity = (Vector2){ cosf(angle) * PLAYER_MAX_SPEED, sinf(angle) * PLAYER_MAX_SPEED };
+        fast->player.isOnGround = false;
+        fast->delta = 0.1f;
+
+        // Line of sight over a few tiles, in any direction
+        const float rayAngle = benchRandom(0.0f, 2.0f * 3.14159265f);
+        benchRandomRays[i].origin = benchRandomBoxes[i].center;
+        benchRandomRays[i].direction = (Vector2){ cosf(rayAngle), sinf(rayAngle) };
+        benchRandomRays[i].maxDistance = 8.0f;
+
+        // From the empty tile above the floor of the bottom screen, along the longest open line up
+        // it has, with no distance limit: the most tiles crossed before a hit
+        int rayX = 0;
+        int rayY = 0;
+        do {
+            rayX = (int)benchRandom(0.0f, (float)TILEMAP_SIZE_X);
+            rayY = (int)bottom - 1;
+            while (rayY > (int)top && worldSolidsIsTileFull(&benchWorld, rayX, rayY)) rayY--;
+        } while (worldSolidsIsTileFull(&benchWorld, rayX, rayY));
+        benchLongRays[i].origin = (Vector2){ (float)rayX + 0.5f, (float)rayY + 0.5f };
+        benchLongRays[i].maxDistance = INFINITY;
+
+        // The player box moving a few tiles in any direction, from anywhere it fits
+        benchBoxTraces[i] = benchRandomRays[i];
+        while (isBoxCollidingWithTilemap(&benchWorld, benchBoxTraces[i].origin, PLAYER_SIZE)) {
+            benchBoxTraces[i].origin = (Vector2){ benchRandom(0.0f, (float)TILEMAP_SIZE_X), benchRandom(top, bottom) };
+        }
+
+        // Along a wall it touches: the distance field never allows a jump ahead, every trace is a full sweep
+        findBenchWallTile(&x, &y);
+        const bool isWallBelow = worldSolidsIsTileFull(&benchWorld, x, y + 1);
+        benchWallTraces[i].origin = (Vector2){ (float)x + 0.5f, isWallBelow ? (float)(y + 1) - PLAYER_SIZE.y : (float)y + 0.5f };
+        benchWallTraces[i].direction = isWallBelow ? (Vector2){ benchRandom(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f, 0.0f }
+                                                   : (Vector2){ 0.0f, benchRandom(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f };
+        benchWallTraces[i].maxDistance = 8.0f;
+        float longest = -1.0f;
+        for (int j = 0; j < 8; j++) {
+            const TileRay candidate = { benchLongRays[i].origin, { benchRandom(-0.4f, 0.4f), -1.0f }, INFINITY };
+            const float distance = castRayAgainstTilemap(&benchWorld, &candidate).distance;
+            if (distance > longest) {
+                longest = distance;
+                benchLongRays[i].direction = candidate.direction;
+            }
+        }
+    }
+
+    for (int i = 0; i < 64; i++) {
+        for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
+            benchRandomSolids[i][y] = (uint16_t)(benchRandom(0.0f, 65536.0f)) & TILEMAP_SOLIDS_ROW_FULL;
+            benchCheckerSolids[i][y] = (uint16_t)((y & 1) ? 0x5555 : 0xaaaa) & TILEMAP_SOLIDS_ROW_FULL;
+            for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+                benchRandomTilemaps[i][y][x] = benchRandom(0.0f, 1.0f) < 0.4f ? TILE_FULL : TILE_EMPTY;
+            }
+            benchRandomTilemaps[i][y][TILEMAP_SIZE_X] = TILE_ZERO;
+        }
+    }
+    benchBigTilemaps = allocateTilemaps(BENCH_BIG_LEVEL_SCREENS);
+    benchBigSolids = allocateTilemapSolids(BENCH_BIG_LEVEL_SCREENS);
+}
+
+uint64_t
+benchTilesOverlapped(const BenchBox* boxes, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const BenchBox* box = &boxes[i & (BENCH_INPUT_COUNT - 1)];
+        int startX, startY, endX, endY;
+        getTilesOverlappedByBox(&startX, &startY, &endX, &endY, box->center, box->size);
+        sum += (uint64_t)(startX + startY * 3 + endX * 5 + endY * 7);
+    }
+    return sum;
+}
+
+uint64_t benchTilesOverlappedRandom(size_t iterations) { return benchTilesOverlapped(benchRandomBoxes, iterations); }
+uint64_t benchTilesOverlappedWorst(size_t iterations) { return benchTilesOverlapped(benchNegativeBoxes, iterations); }
+
+uint64_t
+benchIsColliding(const BenchBox* boxes, size_t iterations)
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const BenchBox* box = &boxes[i & (BENCH_INPUT_COUNT - 1)];
+        count += isBoxCollidingWithTilemap(&benchWorld, box->center, box->size);
+    }
+    return count;
+}
+
+uint64_t benchIsCollidingRandom(size_t iterations) { return benchIsColliding(benchRandomBoxes, iterations); }
+uint64_t benchIsCollidingWorst(size_t iterations) { return benchIsColliding(benchTouchingBoxes, iterations); }
+
+uint64_t
+benchResolve(const BenchBox* boxes, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const BenchBox* box = &boxes[i & (BENCH_INPUT_COUNT - 1)];
+        Vector2 center = box->center;
+        Vector2 velocity = { 3.0f, 5.0f };
+        sum += resolveBoxCollisionWithTilemap(&benchWorld, &center, &velocity, box->size);
+        sum += benchFloatBits(center.x) ^ benchFloatBits(velocity.y);
+    }
+    return sum;
+}
+
+uint64_t benchResolveRandom(size_t iterations) { return benchResolve(benchRandomBoxes, iterations); }
+uint64_t benchResolveWorst(size_t iterations) { return benchResolve(benchCornerBoxes, iterations); }
+
+uint64_t
+benchUpdatePlayer(const BenchPlayer* players, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const BenchPlayer* p = &players[i & (BENCH_INPUT_COUNT - 1)];
+        Player sim = p->player;
+        sum += (uint64_t)updatePlayer(&sim, &benchWorld, &p->input, p->delta);
+        sum += benchFloatBits(sim.position.x) ^ benchFloatBits(sim.position.y);
+    }
+    return sum;
+}
+
+uint64_t benchUpdatePlayerRandom(size_t iterations) { return benchUpdatePlayer(benchRandomPlayers, iterations); }
+uint64_t benchUpdatePlayerWorst(size_t iterations) { return benchUpdatePlayer(benchFastPlayers, iterations); }
+
+// The built-in level: allocation, copying the screens and building their collision layers
+uint64_t
+benchCreateTilemap(size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        TilemapSolids* solids = NULL;
+        Tilemap* tilemaps = createTilemap(numOfLevels, &solids);
+        sum += solids[i % numOfLevels][i % TILEMAP_SIZE_Y];
+        freeTilemaps(tilemaps);
+        freeTilemapSolids(solids);
+    }
+    return sum;
+}
+
+// One screen of random tiles into a big level, all of it lands in cold memory
+uint64_t
+benchInsertScreen(size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const size_t screen = (i * 97) % BENCH_BIG_LEVEL_SCREENS;
+        insertLevelInMap(&benchRandomTilemaps[i & 63], benchBigTilemaps, benchBigSolids, screen);
+        sum += benchBigSolids[screen][i % TILEMAP_SIZE_Y];
+    }
+    return sum;
+}
+
+// Sprites of a whole screen: neighbor masks, then the table
+uint64_t
+benchAutotile(const TilemapSolids* screens, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const TilemapSolids* solids = &screens[i & 63];
+        for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
+            uint8_t masks[TILEMAP_SIZE_X];
+            autotileRowMasks(solids, y, masks);
+            for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+                const AutotileSprite sprite = autotileTable[masks[x]];
+                sum += (uint64_t)(sprite.x + sprite.y * 8);
+            }
+        }
+    }
+    return sum;
+}
+
+uint64_t benchAutotileRandom(size_t iterations) { return benchAutotile(benchRandomSolids, iterations); }
+uint64_t benchAutotileWorst(size_t iterations) { return benchAutotile(benchCheckerSolids, iterations); }
+
+uint64_t
+benchCastRays(const TileRay* rays, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const TileRayHit hit = castRayAgainstTilemap(&benchWorld, &rays[i & (BENCH_INPUT_COUNT - 1)]);
+        sum += benchFloatBits(hit.distance) + (uint64_t)hit.tileX;
+    }
+    return sum;
+}
+uint64_t benchCastRaysRandom(size_t iterations) { return benchCastRays(benchRandomRays, iterations); }
+uint64_t benchCastRaysWorst(size_t iterations) { return benchCastRays(benchLongRays, iterations); }
+
+uint64_t
+benchTraceBoxes(const TileRay* traces, size_t iterations)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        const TileRay* trace = &traces[i & (BENCH_INPUT_COUNT - 1)];
+        sum += benchFloatBits(traceBoxAgainstTilemap(&benchWorld, trace->origin, PLAYER_SIZE, trace->direction, trace->maxDistance));
+    }
+    return sum;
+}
+uint64_t benchTraceBoxesRandom(size_t iterations) { return benchTraceBoxes(benchBoxTraces, iterations); }
+uint64_t benchTraceBoxesWorst(size_t iterations) { return benchTraceBoxes(benchWallTraces, iterations); }
+
+const Benchmark BENCHMARKS[] = {
+    { "getTilesOverlappedByBox", "random", benchTilesOverlappedRandom },
+    { "getTilesOverlappedByBox", "worst", benchTilesOverlappedWorst },
+    { "isBoxCollidingWithTilemap", "random", benchIsCollidingRandom },
+    { "isBoxCollidingWithTilemap", "worst", benchIsCollidingWorst },
+    { "resolveBoxCollisionWithTilemap", "random", benchResolveRandom },
+    { "resolveBoxCollisionWithTilemap", "worst", benchResolveWorst },
+    { "castRayAgainstTilemap", "random", benchCastRaysRandom },
+    { "castRayAgainstTilemap", "worst", benchCastRaysWorst },
+    { "traceBoxAgainstTilemap", "random", benchTraceBoxesRandom },
+    { "traceBoxAgainstTilemap", "worst", benchTraceBoxesWorst },
+    { "updatePlayer", "random", benchUpdatePlayerRandom },
+    { "updatePlayer", "worst", benchUpdatePlayerWorst },
+    { "createTilemap", "builtin", benchCreateTilemap },
+    { "insertLevelInMap", "worst", benchInsertScreen },
+    { "autotileScreen", "random", benchAutotileRandom },
+    { "autotileScreen", "worst", benchAutotileWorst },
+};
+#define BENCHMARK_COUNT (sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]))
+
+int
+compareBenchTimes(const void* a, const void* b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+BenchResult
+runBenchmark(const Benchmark* benchmark, int reps)
+{
+    BenchResult result = { 0 };
+    result.benchmark = benchmark;
+    result.reps = reps;
+
+    // Double the iterations until a repetition is long enough to time
+    size_t iterations = 1;
+    for (;;) {
+        const double start = getBenchSeconds();
+        benchSink += benchmark->run(iterations);
+        if (getBenchSeconds() - start >= BENCH_TARGET_SECONDS || iterations >= ((size_t)1 << 30)) break;
+        iterations *= 2;
+    }
+    result.iterations = iterations;
+
+    for (int i = 0; i < BENCH_WARMUP_REPS; i++) {
+        benchSink += benchmark->run(iterations);
+    }
+
+    double* times = (double*)malloc((size_t)reps * sizeof(double));
+    if (!times) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < reps; i++) {
+        const double start = getBenchSeconds();
+        benchSink += benchmark->run(iterations);
+        times[i] = (getBenchSeconds() - start) * 1e9 / (double)iterations;
+    }
+
+    qsort(times, (size_t)reps, sizeof(double), compareBenchTimes);
+    double sum = 0.0;
+    for (int i = 0; i < reps; i++) {
+        sum += times[i];
+    }
+    result.min = times[0];
+    result.max = times[reps - 1];
+    result.median = (reps % 2) ? times[reps / 2] : (times[reps / 2 - 1] + times[reps / 2]) * 0.5;
+    result.mean = sum / reps;
+    double variance = 0.0;
+    for (int i = 0; i < reps; i++) {
+        variance += (times[i] - result.mean) * (times[i] - result.mean);
+    }
+    result.stddev = reps > 1 ? sqrt(variance / (reps - 1)) : 0.0;
+
+    free(times);
+    return result;
+}
+
+void
+writeBenchJson(FILE* file, const BenchResult* results, int count)
+{
+    fprintf(file, "{\n");
+#if defined(__VERSION__)
+    fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(file, "  \"unit\": \"ns/op\",\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(file,
+                "    { \"name\": \"%s\", \"inputs\": \"%s\", \"iterations\": %zu, \"reps\": %d, "
+                "\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"max\": %.3f }%s\n",
+                r->benchmark->name, r->benchmark->inputs, r->iterations, r->reps,
+                r->min, r->median, r->mean, r->stddev, r->max, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+int
+main(int argc, const char** argv)
+{
+    int reps = BENCH_DEFAULT_REPS;
+    const char* filter = NULL;
+    bool isJson = false;
+    const char* jsonFileName = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+            if (reps < 1) reps = 1;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            isJson = true;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) jsonFileName = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--reps N] [--filter text] [--json [file.json]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    initAutotileTable();
+    prepareBenchInputs();
+
+    BenchResult results[BENCHMARK_COUNT];
+    int count = 0;
+    // With JSON on stdout the table goes to stderr, to keep stdout parseable
+    FILE* table = (isJson && !jsonFileName) ? stderr : stdout;
+    fprintf(table, "%-32s %-7s %12s %10s %10s %10s %10s\n", "benchmark", "inputs", "iterations", "min", "median", "stddev", "max");
+    for (size_t i = 0; i < BENCHMARK_COUNT; i++) {
+        if (filter && !strstr(BENCHMARKS[i].name, filter)) continue;
+        const BenchResult r = runBenchmark(&BENCHMARKS[i], reps);
+        results[count++] = r;
+        fprintf(table, "%-32s %-7s %12zu %10.2f %10.2f %10.2f %10.2f\n",
+                r.benchmark->name, r.benchmark->inputs, r.iterations, r.min, r.median, r.stddev, r.max);
+    }
+
+    if (isJson) {
+        FILE* file = jsonFileName ? fopen(jsonFileName, "w") : stdout;
+        if (!file) {
+            fprintf(stderr, "%s: can't open for writing\n", jsonFileName);
+            return 1;
+        }
+        writeBenchJson(file, results, count);
+        if (file != stdout) fclose(file);
+    }
+
+    freeTilemaps(mainTilemap);
+    freeTilemapSolids(mainTilemapSolids);
+    freeMainTilemapDistances();
+    freeTilemaps(benchBigTilemaps);
+    freeTilemapSolids(benchBigSolids);
+    return 0;
+}
@@ -0,0 +1,3 @@
+del bench.exe
+gcc -std=c99 bench.c -o bench.exe -I raylib/src -O2 -Wall -Wextra -Wno-missing-field-initializers
+bench.exe %*
@@ -0,0 +1,3 @@
+rm -f bench
+gcc -std=c99 bench.c -o bench -I raylib/src -lm -O2 -Wall -Wextra -Wno-missing-field-initializers
+./bench "$@"
@@ -0,0 +1,8 @@
+del jump-ray-headless.exe
+gcc -std=c99 jump-ray-headless.c -o jump-ray-headless.exe -I raylib/src -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
+del level-pack.exe
+gcc -std=c99 level-pack.c -o level-pack.exe -I raylib/src -O2 -Wall -Wextra -Wno-missing-field-initializers
+del level-check.exe
+gcc -std=c99 level-check.c -o level-check.exe -I raylib/src -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
+del level-gen.exe
+gcc -std=c99 level-gen.c -o level-gen.exe -I raylib/src -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
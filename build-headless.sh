@@ -0,0 +1,8 @@
+rm -f jump-ray-headless
+gcc -std=c99 jump-ray-headless.c -o jump-ray-headless -I raylib/src -lm -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
+rm -f level-pack
+gcc -std=c99 level-pack.c -o level-pack -I raylib/src -lm -O2 -Wall -Wextra -Wno-missing-field-initializers
+rm -f level-check
+gcc -std=c99 level-check.c -o level-check -I raylib/src -lm -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
+rm -f level-gen
+gcc -std=c99 level-gen.c -o level-gen -I raylib/src -lm -pthread -O2 -Wall -Wextra -Wno-missing-field-initializers
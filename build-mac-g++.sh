@@ -1,3 +1,5 @@
-rm -f jump-ray
-g++ -std=c++11 jump-ray.c -o jump-ray -I raylib/src -L raylib/src -lraylib -framework OpenGL -framework CoreFoundation -framework CoreGraphics -framework IOKit -framework AppKit -Wall -Wextra -Wno-missing-field-initializers -g
+rm -f jump-ray asset-pack assets-data.h
+g++ -std=c++11 -x c++ asset-pack.c -o asset-pack -I raylib/src -L raylib/src -lraylib -framework OpenGL -framework CoreFoundation -framework CoreGraphics -framework IOKit -framework AppKit
+./asset-pack --header
+g++ -std=c++11 jump-ray.c -o jump-ray -DEMBED_ASSETS -I raylib/src -L raylib/src -lraylib -framework OpenGL -framework CoreFoundation -framework CoreGraphics -framework IOKit -framework AppKit -pthread -Wall -Wextra -Wno-missing-field-initializers -g
 ./jump-ray
@@ -1,4 +1,6 @@
-del jump-ray.exe
+del jump-ray.exe asset-pack.exe assets-data.h
+gcc asset-pack.c -o asset-pack.exe -I raylib/src -L raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm
+asset-pack.exe --header
 :: g++ jump-ray.cpp -o jump-ray.exe -I raylib/src -L raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm -Wall -Wextra -Wno-missing-field-initializers -g
-gcc jump-ray.c -o jump-ray.exe -I raylib/src -L raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm -Wall -Wextra -Wno-missing-field-initializers -g
+gcc jump-ray.c -o jump-ray.exe -DEMBED_ASSETS -I raylib/src -L raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm -pthread -Wall -Wextra -Wno-missing-field-initializers -g
 .\jump-ray.exe
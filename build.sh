@@ -1,3 +1,5 @@
-rm -f jump-ray
-gcc jump-ray.c -o jump-ray -I raylib/src -L raylib/src -lraylib -lm -Wextra -Wno-missing-field-initializers -g
+rm -f jump-ray asset-pack assets-data.h
+gcc asset-pack.c -o asset-pack -I raylib/src -L raylib/src -lraylib -lm -pthread
+./asset-pack --header
+gcc jump-ray.c -o jump-ray -DEMBED_ASSETS -I raylib/src -L raylib/src -lraylib -lm -pthread -Wextra -Wno-missing-field-initializers -g
 ./jump-ray
@@ -0,0 +1,424 @@
+
+// How much should the box in `resolveBoxCollisionWithTilemap` bounce of off walls.
+// Mainly player uses this to bounce.
+#define BOUNCE_FACTOR_X 0.45f
+
+
+// Checks whether the box is intersecting any tile in the tilemap.
+// param `world`: collision rows of the level to check
+// param `center`: coordinate of the center of the box (world-space)
+// param `size`: half-extent of the box - half the box sides
+bool
+isBoxCollidingWithTilemap(const WorldSolids* world, Vector2 center, const Vector2 size)
+{
+    int startX = 0;
+    int startY = 0;
+    int endX = 0;
+    int endY = 0;
+    // Get neighbor tile ranges
+    getTilesOverlappedByBox(&startX, &startY, &endX, &endY, center, size);
+
+    // Nothing solid around the box, most of the time there's no need to look at single tiles
+    if (!worldSolidsIsAnyFull(world, startX, startY, endX, endY)) return false;
+
+    // Iterate over close tiles
+    for (int x = startX; x <= endX; x++) {
+        for (int y = startY; y <= endY; y++) {
+            // Skip if non-empty
+            if (!worldSolidsIsTileFull(world, x, y)) continue;
+
+            // Center of the tile box
+            const Vector2 boxPos = { 0.5f + (float)x, 0.5f + (float)y };
+            const Vector2 sizeSum = { size.x + 0.5f, size.y + 0.5f };
+            const Vector2 surfDist = {
+                fabsf(center.x - boxPos.x) - sizeSum.x,
+                fabsf(center.y - boxPos.y) - sizeSum.y,
+            };
+
+            // The two boxes aren't colliding, because
+            // the distance between the surfaces is larger than
+            // zero on one of the axes.
+            if (surfDist.x > 0 || surfDist.y > 0) continue;
+            return true;
+        } // y
+    } // x
+
+    return false;
+}
+
+// This function takes a box and the level's tiles, and tries to make sure the box
+// doesn't intersect with the tilemap.
+//
+// The method:
+// First, we iterate all of the tiles that *could* be colliding with the box (based on the bounding volume).
+// Next, we calculate the distance between near surfaces on each axis.
+// Then we find an axis to 'clip' the position and velocity against.
+//
+// Returns true if the box was clipped against at least one edge.
+//
+// Note: the `size` is half-extent: it's the vector from the center of the box to it's corner.
+//  It's half the actual width and height of the box.
+bool
+resolveBoxCollisionWithTilemap(const WorldSolids* world, Vector2* center, Vector2* velocity, const Vector2 size)
+{
+  bool isClipped = false;
+
+  int startX = 0;
+  int startY = 0;
+  int endX = 0;
+  int endY = 0;
+  // Get neighbor tile ranges
+  getTilesOverlappedByBox(&startX, &startY, &endX, &endY, *center, size);
+
+  // Nothing solid around the box, which is the common case in the air
+  if (!worldSolidsIsAnyFull(world, startX, startY, endX, endY)) return false;
+
+  // Iterate over close tiles
+  for (int x = startX; x <= endX; x++) {
+    for (int y = startY; y <= endY; y++) {
+      // Skip if non-empty
+      if (!worldSolidsIsTileFull(world, x, y)) continue;
+
+      // Center of the tile box
+      const Vector2 boxPos = { 0.5f + (float)x, 0.5f + (float)y };
+      const Vector2 sizeSum = { size.x + 0.5f, size.y + (float)0.5 };
+      const Vector2 surfDist = {
+        fabsf(center->x - boxPos.x) - sizeSum.x,
+        fabsf(center->y - boxPos.y) - sizeSum.y,
+      };
+
+      // The two boxes aren't colliding, because
+      // the distance between the surfaces is larger than
+      // zero on one of the axes.
+      if (surfDist.x > 0 || surfDist.y > 0) continue;
+
+      // Now check the closer neighboring tiles on each axis.
+      // If the tile is empty (and current tile is full), that means
+      // there exists an edge between the two tiles.
+      // Our box should collide against such an edge.
+      // On the other hand, if there is no edge, the box is inside the tiles
+      // and collision cannot be resolved.
+      const bool isXEmpty = !worldSolidsIsTileFull(world, x + (center->x > boxPos.x ? 1 : -1), y);
+      // Warning: positive Y is down in this setup!
+      const bool isYEmpty = !worldSolidsIsTileFull(world, x, y + (center->y > boxPos.y ? 1 : -1));
+
+      // If both neighbors are empty, there aren't any edges to collide against.
+      if (!isXEmpty && !isYEmpty) continue;
+
+      // Clip axis is the axis of an edge which we don't want our box to intersect.
+      bool isClipAxisX = isXEmpty;
+      // In case there are two edges, just get the axis which has the least amount of penetration.
+      if (isXEmpty && isYEmpty) {
+        isClipAxisX = surfDist.x > surfDist.y;
+      }
+
+      isClipped = true;
+
+      // Clip the velocity (or bounce) based on the axis
+      if (isClipAxisX) {
+        if (center->x > boxPos.x) {
+          // Clamp the position exactly to the surface
+          center->x = boxPos.x + sizeSum.x;
+          if (velocity->x < 0.0) {
+            velocity->x = -velocity->x * BOUNCE_FACTOR_X;
+          }
+        } else {
+          center->x = boxPos.x - sizeSum.x;
+          if (velocity->x > 0.0) {
+            velocity->x = -velocity->x * BOUNCE_FACTOR_X;
+          }
+        }
+      } else {
+        if (center->y > boxPos.y) {
+          center->y = boxPos.y + sizeSum.y;
+          velocity->y = fmaxf(velocity->y, 0.0f);
+        } else {
+          center->y = boxPos.y - sizeSum.y;
+          velocity->y = fminf(velocity->y, 0.0f);
+        }
+      }
+
+    } // y
+  } // x
+
+  return isClipped;
+}
+
+// How deep a moving box may end up inside a tile after one step (see `limitBoxMotion`).
+// `resolveBoxCollisionWithTilemap` pushes the box out towards the side it came from,
+// as long as it didn't get past the middle of the tile.
+#define SWEEP_MAX_PENETRATION 0.5f
+
+// Sweeps a box along `motion` and finds the first solid tile it would enter.
+// Returns the time of impact in [0, 1] (1 when nothing is hit), and the hit axis
+// in `outIsHitAxisX`. Tiles the box already touches at the start are ignored,
+// those are handled by `resolveBoxCollisionWithTilemap`.
+//
+// Each tile is grown by the box half-size, so the moving box becomes a moving point (ray),
+// and the entry time is found with the slab method. Only edges next to an empty tile
+// count, a ray entering through an inner edge must have hit the neighbor first.
+float
+sweepBoxAgainstTilemap(const WorldSolids* world, const Vector2 center, const Vector2 size, const Vector2 motion,
+                       bool* outIsHitAxisX)
+{
+    *outIsHitAxisX = false;
+
+    // Tiles under the swept bounds: the start box and end box together
+    const Vector2 end = Vector2Add(center, motion);
+    const Vector2 sweptMin = { fminf(center.x, end.x) - size.x, fminf(center.y, end.y) - size.y };
+    const Vector2 sweptMax = { fmaxf(center.x, end.x) + size.x, fmaxf(center.y, end.y) + size.y };
+    const int startX = (int)floorf(sweptMin.x);
+    const int startY = (int)floorf(sweptMin.y);
+    const int endX = (int)floorf(sweptMax.x);
+    const int endY = (int)floorf(sweptMax.y);
+
+    if (!worldSolidsIsAnyFull(world, startX, startY, endX, endY)) return 1.0f;
+
+    const float invMotionX = motion.x != 0.0f ? 1.0f / motion.x : 0.0f;
+    const float invMotionY = motion.y != 0.0f ? 1.0f / motion.y : 0.0f;
+
+    float timeOfImpact = 1.0f;
+    for (int x = startX; x <= endX; x++) {
+        for (int y = startY; y <= endY; y++) {
+            if (!worldSolidsIsTileFull(world, x, y)) continue;
+
+            // Tile grown by the box size
+            const Vector2 minCorner = { (float)x - size.x, (float)y - size.y };
+            const Vector2 maxCorner = { (float)x + 1.0f + size.x, (float)y + 1.0f + size.y };
+
+            // Already touching at the start
+            if (center.x >= minCorner.x && center.x <= maxCorner.x &&
+                center.y >= minCorner.y && center.y <= maxCorner.y) continue;
+
+            float enterX = -INFINITY;
+            float exitX = INFINITY;
+            if (motion.x != 0.0f) {
+                const float t0 = (minCorner.x - center.x) * invMotionX;
+                const float t1 = (maxCorner.x - center.x) * invMotionX;
+                enterX = fminf(t0, t1);
+                exitX = fmaxf(t0, t1);
+            } else if (center.x <= minCorner.x || center.x >= maxCorner.x) {
+                continue;
+            }
+
+            float enterY = -INFINITY;
+            float exitY = INFINITY;
+            if (motion.y != 0.0f) {
+                const float t0 = (minCorner.y - center.y) * invMotionY;
+                const float t1 = (maxCorner.y - center.y) * invMotionY;
+                enterY = fminf(t0, t1);
+                exitY = fmaxf(t0, t1);
+            } else if (center.y <= minCorner.y || center.y >= maxCorner.y) {
+                continue;
+            }
+
+            const float enter = fmaxf(enterX, enterY);
+            const float exit = fminf(exitX, exitY);
+            if (enter > exit || enter < 0.0f || enter >= timeOfImpact) continue;
+
+            // The edge we came through must be an outer one
+            const bool isHitAxisX = enterX > enterY;
+            const bool isEdge = isHitAxisX
+                ? !worldSolidsIsTileFull(world, x + (motion.x > 0.0f ? -1 : 1), y)
+                : !worldSolidsIsTileFull(world, x, y + (motion.y > 0.0f ? -1 : 1));
+            if (!isEdge) continue;
+
+            timeOfImpact = enter;
+            *outIsHitAxisX = isHitAxisX;
+        } // y
+    } // x
+
+    return timeOfImpact;
+}
+
+// Limits the motion of a box for one step, so it can't pass through thin walls when it's
+// moving fast (or the step is long). The box stops at most `SWEEP_MAX_PENETRATION` inside the
+// first tile it hits, and `resolveBoxCollisionWithTilemap` then clips and bounces it as usual.
+// Normal motion (less than `SWEEP_MAX_PENETRATION` past the contact) is left untouched.
+Vector2
+limitBoxMotion(const WorldSolids* world, const Vector2 center, const Vector2 size, const Vector2 motion)
+{
+    bool isHitAxisX = false;
+    const float timeOfImpact = sweepBoxAgainstTilemap(world, center, size, motion, &isHitAxisX);
+    if (timeOfImpact >= 1.0f) return motion;
+
+    // How far the box would go past the contact, along the hit axis
+    const float axisMotion = fabsf(isHitAxisX ? motion.x : motion.y);
+    const float penetration = axisMotion * (1.0f - timeOfImpact);
+    if (penetration <= SWEEP_MAX_PENETRATION) return motion;
+
+    const float t = timeOfImpact + SWEEP_MAX_PENETRATION / axisMotion;
+    return Vector2Scale(motion, t);
+}
+
+// A ray (or a segment, with a finite `maxDistance`) for `castRayAgainstTilemap`
+typedef struct {
+    Vector2 origin;
+    Vector2 direction; // Doesn't have to be normalized
+    float maxDistance; // Along `direction` normalized, in tiles
+} TileRay;
+
+typedef struct {
+    bool isHit;
+    float distance; // From the origin to `point`, `maxDistance` when nothing was hit
+    Vector2 point; // Where the ray enters the tile
+    int tileX;
+    int tileY;
+    Vector2 normal; // Of the side of the tile it entered through, zero when the origin is inside a full tile
+} TileRayHit;
+
+// Walks a ray through the tile grid cell by cell (Amanatides & Woo, "A Fast Voxel Traversal
+// Algorithm"): every step goes to whichever of the next vertical or horizontal tile edge is closer,
+// so only the tiles the ray crosses are visited, and it stops at the first full one.
+//
+// A ray that leaves the level where the outside is empty (above and below, see `OUTSIDE_TILE_VERTICAL`)
+// stops there, so even an infinite `maxDistance` ends.
+TileRayHit
+castRayAgainstTilemap(const WorldSolids* world, const TileRay* ray)
+{
+    TileRayHit hit = { false, ray->maxDistance, Vector2Zero(), 0, 0, Vector2Zero() };
+
+    int x = (int)floorf(ray->origin.x);
+    int y = (int)floorf(ray->origin.y);
+    if (worldSolidsIsTileFull(world, x, y)) {
+        hit.isHit = true;
+        hit.distance = 0.0f;
+        hit.point = ray->origin;
+        hit.tileX = x;
+        hit.tileY = y;
+        return hit;
+    }
+
+    const float length = Vector2Length(ray->direction);
+    if (length == 0.0f || !(ray->maxDistance > 0.0f)) return hit;
+    const Vector2 direction = Vector2Scale(ray->direction, 1.0f / length);
+
+    // Nothing full around a short ray, most rays in the open end here
+    if (isfinite(ray->maxDistance)) {
+        const Vector2 end = Vector2Add(ray->origin, Vector2Scale(direction, ray->maxDistance));
+        if (!worldSolidsIsAnyFull(world,
+                                  (int)floorf(fminf(ray->origin.x, end.x)), (int)floorf(fminf(ray->origin.y, end.y)),
+                                  (int)floorf(fmaxf(ray->origin.x, end.x)), (int)floorf(fmaxf(ray->origin.y, end.y)))) {
+            return hit;
+        }
+    }
+
+    // Per axis: the tile step, the distance to the next tile edge, and the distance between edges
+    const int stepX = direction.x > 0.0f ? 1 : -1;
+    const int stepY = direction.y > 0.0f ? 1 : -1;
+    const float deltaX = direction.x != 0.0f ? fabsf(1.0f / direction.x) : INFINITY;
+    const float deltaY = direction.y != 0.0f ? fabsf(1.0f / direction.y) : INFINITY;
+    float nextX = direction.x != 0.0f ? ((float)(x + (stepX > 0 ? 1 : 0)) - ray->origin.x) / direction.x : INFINITY;
+    float nextY = direction.y != 0.0f ? ((float)(y + (stepY > 0 ? 1 : 0)) - ray->origin.y) / direction.y : INFINITY;
+
+    const int levelTop = world->topY;
+    const int levelBottom = world->topY + world->rowCount - 1;
+    for (;;) {
+        float distance = 0.0f;
+        if (nextX < nextY) {
+            distance = nextX;
+            x += stepX;
+            nextX += deltaX;
+            hit.normal = (Vector2){ (float)-stepX, 0.0f };
+        } else {
+            distance = nextY;
+            y += stepY;
+            nextY += deltaY;
+            hit.normal = (Vector2){ 0.0f, (float)-stepY };
+        }
+        if (distance > ray->maxDistance) break;
+
+        if (worldSolidsIsTileFull(world, x, y)) {
+            hit.isHit = true;
+            hit.distance = distance;
+            hit.point = Vector2Add(ray->origin, Vector2Scale(direction, distance));
+            hit.tileX = x;
+            hit.tileY = y;
+            return hit;
+        }
+
+        // Out of the level (and the outside is empty) and not moving back in, nothing left to hit
+        if ((y < levelTop && direction.y <= 0.0f) || (y > levelBottom && direction.y >= 0.0f) ||
+            (x < 0 && direction.x <= 0.0f) || (x >= TILEMAP_SIZE_X && direction.x >= 0.0f)) {
+            break;
+        }
+    }
+
+    hit.normal = Vector2Zero();
+    return hit;
+}
+
+// Casts every ray, `outHits[i]` gets the first full tile of `rays[i]`
+void
+castRaysAgainstTilemap(const WorldSolids* world, const TileRay* rays, size_t count, TileRayHit* outHits)
+{
+    for (size_t i = 0; i < count; i++) {
+        outHits[i] = castRayAgainstTilemap(world, &rays[i]);
+    }
+}
+
+// First full tile on the segment from `start` to `end`
+TileRayHit
+castSegmentAgainstTilemap(const WorldSolids* world, const Vector2 start, const Vector2 end)
+{
+    const TileRay ray = { start, Vector2Subtract(end, start), Vector2Distance(start, end) };
+    return castRayAgainstTilemap(world, &ray);
+}
+
+// Whether `end` can be seen from `start` (no full tile in between)
+bool
+isLineOfSightClear(const WorldSolids* world, const Vector2 start, const Vector2 end)
+{
+    return !castSegmentAgainstTilemap(world, start, end).isHit;
+}
+
+// Sweeps in `traceBoxAgainstTilemap` reach this much past their stretch, so a contact right at
+// the end isn't missed by the next sweep (which ignores the tiles touched at its start)
+#define TRACE_SWEEP_OVERLAP 0.01f
+
+// How far a box can move along `direction` before it enters a full tile, at most `maxDistance`.
+// Tiles the box touches at the start are ignored, like in `sweepBoxAgainstTilemap`.
+//
+// Sphere tracing with the distance field (see `TilemapDistances`): in the open the box jumps
+// ahead by as much as the field says is empty around it, next to walls it's swept a tile at a time.
+float
+traceBoxAgainstTilemap(const WorldSolids* world, const Vector2 center, const Vector2 size, const Vector2 direction,
+                       float maxDistance)
+{
+    const float length = Vector2Length(direction);
+    if (length == 0.0f || !(maxDistance > 0.0f)) return 0.0f;
+    const Vector2 unit = Vector2Scale(direction, 1.0f / length);
+
+    float distance = 0.0f;
+    while (distance < maxDistance) {
+        const Vector2 at = Vector2Add(center, Vector2Scale(unit, distance));
+
+        int startX = 0;
+        int startY = 0;
+        int endX = 0;
+        int endY = 0;
+        getTilesOverlappedByBox(&startX, &startY, &endX, &endY, at, size);
+
+        // The box covers tiles up to `reach` away from the tile of its center, after moving by
+        // `free` in any direction it covers tiles up to `reach + free` away, which are all empty
+        const int tileX = (int)floorf(at.x);
+        const int tileY = (int)floorf(at.y);
+        int reach = tileX - startX;
+        if (endX - tileX > reach) reach = endX - tileX;
+        if (tileY - startY > reach) reach = tileY - startY;
+        if (endY - tileY > reach) reach = endY - tileY;
+        const int free = getWorldSolidsDistance(world, tileX, tileY) - reach - 1;
+        if (free >= 1) {
+            distance = fminf(distance + (float)free, maxDistance);
+            continue;
+        }
+
+        const float stretch = fminf(1.0f, maxDistance - distance);
+        const float sweep = stretch + TRACE_SWEEP_OVERLAP;
+        bool isHitAxisX = false;
+        const float timeOfImpact = sweepBoxAgainstTilemap(world, at, size, Vector2Scale(unit, sweep), &isHitAxisX);
+        if (timeOfImpact < 1.0f) return fminf(distance + timeOfImpact * sweep, maxDistance);
+        distance += stretch;
+    }
+    return maxDistance;
+}
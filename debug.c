@@ -0,0 +1,106 @@
+
+// Debug overlay (toggled with 'I').
+// The per-tile labels only change with the screen or the window scale, so they are drawn
+// once into a render texture. The HUD text is redrawn into its own texture a few times per second.
+
+#define DEBUG_HUD_REFRESH_INTERVAL 0.1f
+#define DEBUG_HUD_PIXELS_X 640
+#define DEBUG_HUD_PIXELS_Y 180
+
+typedef struct {
+  RenderTexture tileLabels;
+  int tileLabelsScreenIndex; // -1 when the labels need to be redrawn
+  float tileLabelsScale;
+
+  RenderTexture hud;
+  float hudAge; // Seconds since the HUD texture was redrawn
+} DebugOverlay;
+
+DebugOverlay debugOverlay = { 0 };
+
+void
+loadDebugOverlay(void)
+{
+  debugOverlay.tileLabelsScreenIndex = -1;
+  debugOverlay.hud = LoadRenderTexture(DEBUG_HUD_PIXELS_X, DEBUG_HUD_PIXELS_Y);
+  debugOverlay.hudAge = DEBUG_HUD_REFRESH_INTERVAL;
+}
+
+void
+unloadDebugOverlay(void)
+{
+  if (debugOverlay.tileLabelsScale > 0.0f) UnloadRenderTexture(debugOverlay.tileLabels);
+  UnloadRenderTexture(debugOverlay.hud);
+  debugOverlay.tileLabelsScale = 0.0f;
+}
+
+// Redraw the tile labels next time (e.g. after the screen's tiles changed)
+void
+invalidateDebugOverlay(void)
+{
+  debugOverlay.tileLabelsScreenIndex = -1;
+}
+
+// Redraw the cached layers when needed.
+// Note: must be called outside of `BeginTextureMode`/`EndTextureMode`.
+void
+updateDebugOverlay(const Tilemap* tilemap, int screenIndex, float scale, float delta,
+                   const Player* player, float screenOffsetY)
+{
+  if (scale != debugOverlay.tileLabelsScale) {
+    if (debugOverlay.tileLabelsScale > 0.0f) UnloadRenderTexture(debugOverlay.tileLabels);
+    debugOverlay.tileLabels = LoadRenderTexture((int)(VIEW_PIXELS_X * scale), (int)(VIEW_PIXELS_Y * scale));
+    debugOverlay.tileLabelsScale = scale;
+    debugOverlay.tileLabelsScreenIndex = -1;
+  }
+
+  if (screenIndex != debugOverlay.tileLabelsScreenIndex) {
+    BeginTextureMode(debugOverlay.tileLabels);
+    ClearBackground(BLANK);
+    for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+      for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
+        Tile tile = tilemapGetTile(tilemap, x, y);
+        Vector2 worldPos = { (float)x * scale, (float)y * scale };
+        Vector2 textOffset = { 3, 3};
+        DrawTextEx(GetFontDefault(), TextFormat("[%i,%i]\n%i\n\'%c\'", x, y, tile, tile),
+                   Vector2Add(worldToScreen(worldPos), textOffset),
+                   10, 1, RED);
+      }
+    }
+    EndTextureMode();
+    debugOverlay.tileLabelsScreenIndex = screenIndex;
+  }
+
+  debugOverlay.hudAge += delta;
+  if (debugOverlay.hudAge >= DEBUG_HUD_REFRESH_INTERVAL) {
+    BeginTextureMode(debugOverlay.hud);
+    ClearBackground(BLANK);
+    DrawText(TextFormat("player.jumpHoldTime = %f", player->jumpHoldTime), 1, 88, 20, WHITE);
+    DrawText(TextFormat("player.position = [%f, %f]", player->position.x, player->position.y), 1, 110, 20, WHITE);
+    DrawText(TextFormat("screenOffset = %f", screenOffsetY), 1, 22 * 6, 20, WHITE);
+    DrawText(TextFormat("screenIndex = %i", screenIndex), 1, 22 * 7, 20, WHITE);
+    EndTextureMode();
+    debugOverlay.hudAge = 0.0f;
+  }
+}
+
+// Draw a render texture with its top left corner at `position` (render textures are upside down)
+void
+drawRenderTexture(const RenderTexture renderTexture, const Vector2 position)
+{
+  Rectangle source = { 0, 0, (float)renderTexture.texture.width, -(float)renderTexture.texture.height };
+  DrawTextureRec(renderTexture.texture, source, position, WHITE);
+}
+
+void
+drawDebugTileLabels(const Vector2 offset)
+{
+  drawRenderTexture(debugOverlay.tileLabels, offset);
+}
+
+void
+drawDebugHud(void)
+{
+  drawRenderTexture(debugOverlay.hud, Vector2Zero());
+  DrawFPS(1, 1);
+}
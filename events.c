@@ -0,0 +1,58 @@
+
+// Physics events of a frame, queued for the audio (or anything else that reacts to them).
+//
+// `stepPlayer` only returns `PlayerEvent` flags. The game turns them into typed events with
+// where and how hard they happened, and handles the whole queue once per frame, after the
+// physics steps, so nothing outside of physics runs in between them.
+
+#define GAME_EVENT_QUEUE_SIZE 64
+
+typedef enum {
+    GAME_EVENT_JUMP,
+    GAME_EVENT_LAND,
+    GAME_EVENT_BUMP,
+    GAME_EVENT_TYPE_COUNT,
+} GameEventType;
+
+typedef struct {
+    uint8_t type; // `GameEventType`
+    uint32_t step; // Physics step it happened on
+    Vector2 position;
+    float speed; // Jump: take-off speed; land: falling speed; bump: horizontal speed into the wall
+} GameEvent;
+
+typedef struct {
+    GameEvent events[GAME_EVENT_QUEUE_SIZE];
+    int count;
+    int droppedCount; // Didn't fit, only possible after a very long frame
+} GameEventQueue;
+
+void
+pushGameEvent(GameEventQueue* queue, GameEventType type, uint32_t step, Vector2 position, float speed)
+{
+    if (queue->count >= GAME_EVENT_QUEUE_SIZE) {
+        queue->droppedCount++;
+        return;
+    }
+    GameEvent* event = &queue->events[queue->count++];
+    event->type = (uint8_t)type;
+    event->step = step;
+    event->position = position;
+    event->speed = speed;
+}
+
+// Queue the events of one `stepPlayer` call, `before` is the player the step started from
+void
+pushPlayerStepEvents(GameEventQueue* queue, int events, uint32_t step, const Player* before, const Player* after)
+{
+    if (events & PLAYER_EVENT_LAND) pushGameEvent(queue, GAME_EVENT_LAND, step, after->position, fabsf(before->velocity.y));
+    if (events & PLAYER_EVENT_JUMP) pushGameEvent(queue, GAME_EVENT_JUMP, step, after->position, Vector2Length(after->velocity));
+    if (events & PLAYER_EVENT_BUMP) pushGameEvent(queue, GAME_EVENT_BUMP, step, after->position, fabsf(before->velocity.x));
+}
+
+void
+clearGameEvents(GameEventQueue* queue)
+{
+    queue->count = 0;
+    queue->droppedCount = 0;
+}
@@ -0,0 +1,129 @@
+
+// Replay ghosts: recorded runs (input recordings, see record.c) played back as translucent players
+// next to the real one, e.g. the best runs of a leaderboard.
+//
+// Every ghost is a lane of an `AgentBatch` (agents.c): each physics step reads the next input of
+// every recording, then steps all the ghosts at once. Drawing skips the ghosts that aren't on
+// the current screen and draws the others from the sprite atlas, so they all go in one batch
+// (one draw call), and 100 ghosts cost about the same as one.
+//
+// Ghosts start with the game and follow its physics steps. A ghost whose recording ended stays
+// where it is.
+
+#define GHOST_DIRECTORY "ghosts"
+#define GHOST_MAX_COUNT 128
+#define GHOST_ALPHA 0.35f
+
+typedef struct {
+  size_t count;
+  InputReplay replays[GHOST_MAX_COUNT];
+  bool isDone[GHOST_MAX_COUNT];
+  PlayerInput inputs[GHOST_MAX_COUNT];
+  AgentBatch agents;
+
+  // For drawing: where each ghost was before the last step, and its animation time
+  Vector2 previousPositions[GHOST_MAX_COUNT];
+  float animTimes[GHOST_MAX_COUNT];
+} GhostSet;
+
+GhostSet ghosts = { 0 };
+
+// The recordings (*.jri) in `directory` that were recorded on this level, at most `GHOST_MAX_COUNT`
+void
+loadGhosts(const char* directory, const WorldSolids* world)
+{
+  ghosts.count = 0;
+  if (!DirectoryExists(directory)) return;
+
+  const uint32_t levelHash = hashWorldSolids(world);
+  FilePathList files = LoadDirectoryFilesEx(directory, ".jri", false);
+  for (unsigned int i = 0; i < files.count && ghosts.count < GHOST_MAX_COUNT; i++) {
+    InputReplay* replay = &ghosts.replays[ghosts.count];
+    if (!openInputReplay(replay, files.paths[i])) continue;
+    if (replay->header.levelHash != levelHash || replay->header.tickRate != PHYSICS_TICK_RATE) {
+      fprintf(stderr, "%s: recorded on a different level or tick rate, skipped\n", files.paths[i]);
+      closeInputReplay(replay);
+      continue;
+    }
+    ghosts.count++;
+  }
+  UnloadDirectoryFiles(files);
+
+  createAgentBatch(&ghosts.agents, ghosts.count);
+  for (size_t i = 0; i < ghosts.count; i++) {
+    Player ghost = player;
+    ghost.position = (Vector2){ ghosts.replays[i].header.startX, ghosts.replays[i].header.startY };
+    ghost.velocity = Vector2Zero();
+    ghost.jumpHoldTime = 0.0f;
+    setAgent(&ghosts.agents, i, &ghost);
+    ghosts.isDone[i] = false;
+    ghosts.previousPositions[i] = ghost.position;
+    ghosts.animTimes[i] = 0.0f;
+  }
+}
+
+void
+unloadGhosts(void)
+{
+  for (size_t i = 0; i < ghosts.count; i++) {
+    closeInputReplay(&ghosts.replays[i]);
+  }
+  if (ghosts.agents.capacity > 0) freeAgentBatch(&ghosts.agents);
+  ghosts.count = 0;
+}
+
+// One physics step of every ghost: the next input of each recording, then one batched step
+void
+stepGhosts(const WorldSolids* world)
+{
+  if (ghosts.count == 0) return;
+
+  AgentBatch* agents = &ghosts.agents;
+  for (size_t i = 0; i < ghosts.count; i++) {
+    ghosts.previousPositions[i] = (Vector2){ agents->positionX[i], agents->positionY[i] };
+
+    // A rewind or the debug keys set the whole player, so the ghost follows the same path
+    Player ghost = getAgent(agents, i);
+    ghost.animTime = ghosts.animTimes[i];
+    bool isGhostSet = false;
+    if (ghosts.isDone[i] || !nextReplayInput(&ghosts.replays[i], &ghosts.inputs[i], &ghost, &isGhostSet)) {
+      ghosts.isDone[i] = true;
+      ghosts.inputs[i] = (PlayerInput){ 0 };
+    }
+    if (isGhostSet) {
+      setAgent(agents, i, &ghost);
+      ghosts.animTimes[i] = ghost.animTime;
+      ghosts.previousPositions[i] = ghost.position;
+    }
+  }
+
+  stepAgents(agents, world, ghosts.inputs, PHYSICS_DELTA, NULL);
+
+  // Same as `applyPlayerGroundInput`: starting to walk restarts the walk animation
+  for (size_t i = 0; i < ghosts.count; i++) {
+    const PlayerInput* input = &ghosts.inputs[i];
+    if ((agents->flags[i] & AGENT_ON_GROUND) && input->isMovePressed && !input->isJumpDown) {
+      ghosts.animTimes[i] = 0.0f;
+    }
+  }
+}
+
+// Draw the ghosts on the current screen, between their last two steps like the player.
+// Call inside the pixel art pass: every sprite comes from the atlas, so they're one batch.
+void
+drawGhosts(int screenIndex, float screenOffsetY, float interpolation, float delta)
+{
+  const Color tint = Fade(WHITE, GHOST_ALPHA);
+  for (size_t i = 0; i < ghosts.count; i++) {
+    ghosts.animTimes[i] += delta;
+
+    Player ghost = getAgent(&ghosts.agents, i);
+    const Vector2 position = Vector2Lerp(ghosts.previousPositions[i], ghost.position, interpolation);
+    if (getScreenIndex(position.y) != screenIndex) continue;
+
+    ghost.animTime = ghosts.animTimes[i];
+    const Vector2 screenPos = getPlayerSpritePosition((Vector2){ position.x, position.y - screenOffsetY });
+    const Vector2 scale = { (float)(ghost.isFacingRight ? 1 : -1), 1 };
+    drawAtlasSpriteTinted(SPRITE_SHEET_PLAYER, getPlayerSprite(&ghost), 0, screenPos, scale, tint);
+  }
+}
@@ -1,7 +1,3 @@
-Sound jumpWav;
-Sound bumpWav;
-Sound floorWav;
-
 // Get start and end coordinates of the boxes a bounding box on the tilemap grid
 void
 getTilesOverlappedByBox(int* outStartX, int* outStartY, int* outEndX, int* outEndY, Vector2 center, const Vector2 size)
@@ -0,0 +1,26 @@
+
+// Read keyboard and gamepad into a `PlayerInput` snapshot for this frame.
+PlayerInput
+readPlayerInput(void)
+{
+    PlayerInput input = { 0 };
+
+    if (IsGamepadAvailable(0)) {
+        const float leftStickDeadzoneX = 0.1f;
+        float leftStickX = GetGamepadAxisMovement(0, GAMEPAD_AXIS_LEFT_X);
+        if (leftStickX > -leftStickDeadzoneX && leftStickX < leftStickDeadzoneX) leftStickX = 0.0f;
+
+        input.isGamepad = true;
+        input.stickX = leftStickX;
+    }
+
+    input.isJumpDown = IsKeyDown(KEY_SPACE) ||
+        (input.isGamepad && IsGamepadButtonDown(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN));
+    input.isJumpReleased = IsKeyReleased(KEY_SPACE) ||
+        (input.isGamepad && IsGamepadButtonReleased(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN));
+    input.isRightDown = IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D);
+    input.isLeftDown = IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A);
+    input.isMovePressed = IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_D) || IsKeyPressed(KEY_A);
+
+    return input;
+}
@@ -0,0 +1,535 @@
+// Headless build of the game simulation.
+// Links only against libc/libm (raymath.h is header-only), no window, input or audio.
+// Steps a scripted bot through the level as fast as possible and reports throughput.
+//
+// With `--agents N`, steps N agents with made up inputs side by side, once one by one with `stepPlayer`
+// and once together with `stepAgents` (agents.c), checks that both end up the same and compares the
+// speed of the steps alone.
+//
+// With `--jobs N`, runs N short independent rollouts (runner.c) of `frames` steps each, once on one thread
+// and once on all cores (or `--threads T`), and checks that both give the same results.
+//
+// With `--record file.jri`, the bot's input is recorded (record.c), and `--replay file.jri` feeds
+// a recording (e.g. `last-session.jri` written by the game) through the physics as fast as possible.
+//
+// With `--rewind bytes`, the bot rewinds now and then like the game's Backspace, with a rewind buffer
+// (rewind.c) of that many bytes. Every restored snapshot is checked against a plain history, then
+// the recorded session is replayed and checked step by step.
+//
+// Usage: jump-ray-headless [--record file.jri | --agents N | --jobs N [--threads T]] [frames] [level.jrl]
+//        jump-ray-headless --rewind bytes [--record file.jri] [frames] [level.jrl]
+//        jump-ray-headless --replay file.jri [level.jrl]
+
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h" // Vector math (header-only)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <stdlib.h> // strtoull
+#include <string.h> // strcmp, memcmp
+#include <time.h> // clock
+
+#include "globals.c"
+#include "tilemap.c"
+#include "collision.c"
+#include "player.c"
+#include "level.c"
+#include "agents.c"
+#include "runner.c"
+#include "record.c"
+#include "rewind.c"
+
+// Tiny deterministic bot: charges a jump for a pseudo-random time, releases it
+// in a pseudo-random direction and waits until it lands again.
+typedef struct {
+    uint32_t seed;
+    int chargeTicks;
+    int direction; // -1 left, 0 up, 1 right
+} HeadlessBot;
+
+uint32_t
+headlessRandom(uint32_t* seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+PlayerInput
+headlessBotInput(HeadlessBot* bot, bool isOnGround)
+{
+    PlayerInput input = { 0 };
+    if (!isOnGround) return input;
+
+    if (bot->chargeTicks == 0) {
+        bot->chargeTicks = 1 + (int)(headlessRandom(&bot->seed) % 50);
+        bot->direction = (int)(headlessRandom(&bot->seed) % 3) - 1;
+    }
+
+    input.isRightDown = bot->direction > 0;
+    input.isLeftDown = bot->direction < 0;
+    if (--bot->chargeTicks > 0) {
+        input.isJumpDown = true;
+    } else {
+        input.isJumpReleased = true;
+    }
+    return input;
+}
+
+int
+runHeadlessBot(unsigned long long frames, const WorldSolids* world, const char* recordingFileName)
+{
+    Player sim = player;
+    sim.position = (Vector2){ 7, 10 };
+    HeadlessBot bot = { 12345u, 0, 0 };
+
+    InputRecorder recorder = { 0 };
+    if (recordingFileName && !startInputRecording(&recorder, recordingFileName, world, sim.position)) return 1;
+
+    unsigned long long jumps = 0;
+    unsigned long long landings = 0;
+    unsigned long long bumps = 0;
+
+    const clock_t start = clock();
+    for (unsigned long long frame = 0; frame < frames; frame++) {
+        const PlayerInput input = headlessBotInput(&bot, sim.isOnGround);
+        recordPlayerInput(&recorder, &input, NULL);
+        const PlayerStepResult step = stepPlayer(sim, world, &input, PHYSICS_DELTA);
+        sim = step.player;
+
+        if (step.events & PLAYER_EVENT_JUMP) jumps++;
+        if (step.events & PLAYER_EVENT_LAND) landings++;
+        if (step.events & PLAYER_EVENT_BUMP) bumps++;
+    }
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("frames = %llu\n", frames);
+    printf("seconds = %f\n", seconds);
+    printf("frames/sec = %.0f\n", seconds > 0.0 ? (double)frames / seconds : 0.0);
+    printf("jumps = %llu, landings = %llu, bumps = %llu\n", jumps, landings, bumps);
+    printf("player.position = [%f, %f]\n", sim.position.x, sim.position.y);
+
+    stopInputRecording(&recorder);
+    return 0;
+}
+
+// Feeds a recorded session through the physics as fast as possible
+int
+runHeadlessReplay(const char* fileName, const WorldSolids* world)
+{
+    InputReplay replay;
+    if (!openInputReplay(&replay, fileName)) return 1;
+    if (replay.header.levelHash != hashWorldSolids(world)) {
+        fprintf(stderr, "%s: recorded on a different level (%u screens), the replay will differ\n",
+                fileName, replay.header.screenCount);
+    }
+
+    Player sim = player;
+    sim.position = (Vector2){ replay.header.startX, replay.header.startY };
+    const float delta = 1.0f / (float)replay.header.tickRate;
+
+    unsigned long long steps = 0;
+    unsigned long long jumps = 0;
+    unsigned long long landings = 0;
+    unsigned long long bumps = 0;
+
+    const clock_t start = clock();
+    PlayerInput input;
+    bool isPlayerSet = false;
+    while (nextReplayInput(&replay, &input, &sim, &isPlayerSet)) {
+        const PlayerStepResult step = stepPlayer(sim, world, &input, delta);
+        sim = step.player;
+        steps++;
+
+        if (step.events & PLAYER_EVENT_JUMP) jumps++;
+        if (step.events & PLAYER_EVENT_LAND) landings++;
+        if (step.events & PLAYER_EVENT_BUMP) bumps++;
+    }
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("recording = %s, %zu bytes\n", fileName, replay.size);
+    printf("steps = %llu (%.1f seconds of play)\n", steps, (double)steps * delta);
+    printf("seconds = %f\n", seconds);
+    printf("steps/sec = %.0f\n", seconds > 0.0 ? (double)steps / seconds : 0.0);
+    printf("jumps = %llu, landings = %llu, bumps = %llu\n", jumps, landings, bumps);
+    printf("player.position = [%f, %f]\n", sim.position.x, sim.position.y);
+    printf("player.velocity = [%f, %f]\n", sim.velocity.x, sim.velocity.y);
+    printf("player.isOnGround = %d\n", sim.isOnGround);
+
+    closeInputReplay(&replay);
+    return 0;
+}
+
+#define HEADLESS_REWIND_FILE_NAME "rewind-check.jri"
+// About one rewind every this many steps
+#define HEADLESS_REWIND_INTERVAL 5000
+
+bool
+isHeadlessPlayerSame(const Player* a, const Player* b)
+{
+    return a->position.x == b->position.x && a->position.y == b->position.y &&
+           a->velocity.x == b->velocity.x && a->velocity.y == b->velocity.y &&
+           a->jumpHoldTime == b->jumpHoldTime && a->animTime == b->animTime &&
+           a->isOnGround == b->isOnGround && a->isFacingRight == b->isFacingRight;
+}
+
+// The bot rewinds a random number of steps now and then and plays on, recording its input like the game
+int
+runHeadlessRewind(size_t rewindBytes, unsigned long long frames, const WorldSolids* world, const char* recordingFileName)
+{
+    const char* fileName = recordingFileName ? recordingFileName : HEADLESS_REWIND_FILE_NAME;
+    Player sim = player;
+    sim.position = (Vector2){ 7, 10 };
+    HeadlessBot bot = { 12345u, 0, 0 };
+    uint32_t seed = 777u;
+
+    InputRecorder recorder = { 0 };
+    if (!startInputRecording(&recorder, fileName, world, sim.position)) return 1;
+    RewindBuffer rewindBuffer;
+    createRewindBuffer(&rewindBuffer, rewindBytes);
+
+    // `history` is the current timeline, a rewind cuts it. `played` is every step as it was played.
+    Player* history = (Player*)allocateAgentArray((size_t)frames, sizeof(Player));
+    Player* played = (Player*)allocateAgentArray((size_t)frames, sizeof(Player));
+    size_t historyCount = 0;
+    size_t snapshotMismatches = 0;
+    unsigned long long rewinds = 0;
+    unsigned long long rewoundSteps = 0;
+    bool isPlayerSet = false;
+
+    const clock_t start = clock();
+    for (unsigned long long frame = 0; frame < frames; frame++) {
+        // Same as releasing Backspace: play on from the rewound step
+        if (rewindBuffer.snapshotCount > 0 && headlessRandom(&seed) % HEADLESS_REWIND_INTERVAL == 0) {
+            const size_t stepsBack = headlessRandom(&seed) % rewindBuffer.snapshotCount;
+            if (!getRewindSnapshot(&rewindBuffer, stepsBack, &sim) ||
+                !isHeadlessPlayerSame(&sim, &history[historyCount - 1 - stepsBack])) {
+                snapshotMismatches++;
+            }
+            dropNewestRewindSnapshots(&rewindBuffer, stepsBack);
+            historyCount -= stepsBack;
+            bot = (HeadlessBot){ headlessRandom(&seed), 0, 0 };
+            rewinds++;
+            rewoundSteps += stepsBack;
+            isPlayerSet = true;
+        }
+
+        const PlayerInput input = headlessBotInput(&bot, sim.isOnGround);
+        recordPlayerInput(&recorder, &input, isPlayerSet ? &sim : NULL);
+        isPlayerSet = false;
+        sim = stepPlayer(sim, world, &input, PHYSICS_DELTA).player;
+        pushRewindSnapshot(&rewindBuffer, &sim);
+        history[historyCount++] = sim;
+        played[frame] = sim;
+
+        // And look at some older snapshot, like scrubbing
+        const size_t stepsBack = headlessRandom(&seed) % rewindBuffer.snapshotCount;
+        Player snapshot;
+        if (!getRewindSnapshot(&rewindBuffer, stepsBack, &snapshot) ||
+            !isHeadlessPlayerSame(&snapshot, &history[historyCount - 1 - stepsBack])) {
+            snapshotMismatches++;
+        }
+    }
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    stopInputRecording(&recorder);
+
+    // The replay has to play every step the same, the rewound ones too
+    size_t replayMismatches = 0;
+    unsigned long long replaySteps = 0;
+    InputReplay replay;
+    if (openInputReplay(&replay, fileName)) {
+        Player replayed = player;
+        replayed.position = (Vector2){ replay.header.startX, replay.header.startY };
+        PlayerInput input;
+        bool isReplayedSet = false;
+        while (nextReplayInput(&replay, &input, &replayed, &isReplayedSet)) {
+            replayed = stepPlayer(replayed, world, &input, PHYSICS_DELTA).player;
+            if (replaySteps >= frames || !isHeadlessPlayerSame(&replayed, &played[replaySteps])) replayMismatches++;
+            replaySteps++;
+        }
+        closeInputReplay(&replay);
+    }
+    if (replaySteps != frames) replayMismatches++;
+
+    printf("frames = %llu, rewinds = %llu, rewound steps = %llu\n", frames, rewinds, rewoundSteps);
+    printf("seconds = %f\n", seconds);
+    printf("rewind buffer = %zu bytes, %zu used, %zu snapshots\n", rewindBuffer.capacity,
+           getRewindBufferUsedBytes(&rewindBuffer), rewindBuffer.snapshotCount);
+    printf("recording = %s, %llu steps replayed\n", fileName, replaySteps);
+    printf("player.position = [%f, %f]\n", sim.position.x, sim.position.y);
+    printf("snapshot mismatches = %zu, replay mismatches = %zu\n", snapshotMismatches, replayMismatches);
+    printf("mismatches = %zu\n", snapshotMismatches + replayMismatches);
+
+    if (!recordingFileName) remove(fileName);
+    freeRewindBuffer(&rewindBuffer);
+    free(history);
+    free(played);
+    return snapshotMismatches + replayMismatches == 0 ? 0 : 1;
+}
+
+// Input sequences for rollouts: charge a jump, release it and wait for the landing, a few times.
+// Unlike `headlessBotInput` they don't look at the player, so they can be made up front.
+void
+makeHeadlessInputSequence(PlayerInput* inputs, size_t count, uint32_t seed)
+{
+    size_t i = 0;
+    while (i < count) {
+        const int chargeTicks = 1 + (int)(headlessRandom(&seed) % 50);
+        const int direction = (int)(headlessRandom(&seed) % 3) - 1;
+        for (int tick = 0; tick < chargeTicks + 60 && i < count; tick++, i++) {
+            PlayerInput input = { 0 };
+            input.isRightDown = direction > 0;
+            input.isLeftDown = direction < 0;
+            input.isJumpDown = tick < chargeTicks - 1;
+            input.isJumpReleased = tick == chargeTicks - 1;
+            if (tick >= chargeTicks) input.isRightDown = input.isLeftDown = false;
+            inputs[i] = input;
+        }
+    }
+}
+
+// The agents' inputs repeat after this many frames. They're made up front, so only the steps are timed.
+#define HEADLESS_AGENT_INPUT_FRAMES 600
+
+// Each agent starts at its own spot on the bottom screen
+Player
+headlessAgentStart(size_t i)
+{
+    Player agent = player;
+    agent.position = (Vector2){ 2.0f + (float)(i % 13), 10.0f };
+    return agent;
+}
+
+void
+countHeadlessAgentEvents(unsigned long long counts[3], const uint8_t* events, size_t agentCount)
+{
+    for (size_t i = 0; i < agentCount; i++) {
+        if (events[i] & PLAYER_EVENT_JUMP) counts[0]++;
+        if (events[i] & PLAYER_EVENT_LAND) counts[1]++;
+        if (events[i] & PLAYER_EVENT_BUMP) counts[2]++;
+    }
+}
+
+int
+runHeadlessAgents(size_t agentCount, unsigned long long frames, const WorldSolids* world)
+{
+    Player* agents = (Player*)allocateAgentArray(agentCount, sizeof(Player));
+    PlayerInput* inputs = (PlayerInput*)allocateAgentArray(HEADLESS_AGENT_INPUT_FRAMES * agentCount, sizeof(PlayerInput));
+    PlayerInput* sequence = (PlayerInput*)allocateAgentArray(HEADLESS_AGENT_INPUT_FRAMES, sizeof(PlayerInput));
+    uint8_t* events = (uint8_t*)allocateAgentArray(agentCount, sizeof(uint8_t));
+    unsigned long long eventCounts[2][3] = { 0 };
+
+    // Frame by frame, so the inputs of a step are next to each other
+    for (size_t i = 0; i < agentCount; i++) {
+        makeHeadlessInputSequence(sequence, HEADLESS_AGENT_INPUT_FRAMES, 12345u + (uint32_t)i * 7919u);
+        for (size_t frame = 0; frame < HEADLESS_AGENT_INPUT_FRAMES; frame++) {
+            inputs[frame * agentCount + i] = sequence[frame];
+        }
+    }
+
+    // One by one
+    for (size_t i = 0; i < agentCount; i++) {
+        agents[i] = headlessAgentStart(i);
+    }
+    double scalarSeconds = 0.0;
+    for (unsigned long long frame = 0; frame < frames; frame++) {
+        const PlayerInput* frameInputs = &inputs[frame % HEADLESS_AGENT_INPUT_FRAMES * agentCount];
+        const double start = getWallSeconds();
+        for (size_t i = 0; i < agentCount; i++) {
+            const PlayerStepResult step = stepPlayer(agents[i], world, &frameInputs[i], PHYSICS_DELTA);
+            agents[i] = step.player;
+            events[i] = (uint8_t)step.events;
+        }
+        scalarSeconds += getWallSeconds() - start;
+        countHeadlessAgentEvents(eventCounts[0], events, agentCount);
+    }
+
+    // All together
+    AgentBatch batch;
+    createAgentBatch(&batch, agentCount);
+    for (size_t i = 0; i < agentCount; i++) {
+        const Player agent = headlessAgentStart(i);
+        setAgent(&batch, i, &agent);
+    }
+    double batchSeconds = 0.0;
+    for (unsigned long long frame = 0; frame < frames; frame++) {
+        const PlayerInput* frameInputs = &inputs[frame % HEADLESS_AGENT_INPUT_FRAMES * agentCount];
+        const double start = getWallSeconds();
+        stepAgents(&batch, world, frameInputs, PHYSICS_DELTA, events);
+        batchSeconds += getWallSeconds() - start;
+        countHeadlessAgentEvents(eventCounts[1], events, agentCount);
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < agentCount; i++) {
+        const Player agent = getAgent(&batch, i);
+        if (agent.position.x != agents[i].position.x || agent.position.y != agents[i].position.y ||
+            agent.velocity.x != agents[i].velocity.x || agent.velocity.y != agents[i].velocity.y ||
+            agent.isOnGround != agents[i].isOnGround) {
+            mismatches++;
+        }
+    }
+
+    const double steps = (double)frames * (double)agentCount;
+    printf("agents = %zu, frames = %llu, lanes = %d\n", agentCount, frames, AGENT_LANES);
+    printf("stepPlayer: seconds = %f, steps/sec = %.0f\n", scalarSeconds, scalarSeconds > 0.0 ? steps / scalarSeconds : 0.0);
+    printf("stepAgents: seconds = %f, steps/sec = %.0f\n", batchSeconds, batchSeconds > 0.0 ? steps / batchSeconds : 0.0);
+    printf("jumps = %llu, landings = %llu, bumps = %llu\n", eventCounts[1][0], eventCounts[1][1], eventCounts[1][2]);
+    printf("mismatches = %zu\n", mismatches);
+    if (memcmp(eventCounts[0], eventCounts[1], sizeof(eventCounts[0])) != 0) {
+        printf("event counts differ: jumps = %llu, landings = %llu, bumps = %llu\n",
+               eventCounts[0][0], eventCounts[0][1], eventCounts[0][2]);
+        mismatches++;
+    }
+
+    freeAgentBatch(&batch);
+    free(agents);
+    free(sequence);
+    free(inputs);
+    free(events);
+    return mismatches == 0 ? 0 : 1;
+}
+
+#define HEADLESS_SEQUENCE_COUNT 64
+
+int
+runHeadlessJobs(size_t jobCount, int threadCount, unsigned long long frames, const WorldSolids* world)
+{
+    // Jobs share a few input sequences and start at different spots
+    const size_t stepCount = (size_t)frames;
+    PlayerInput* sequences = (PlayerInput*)allocateAgentArray(HEADLESS_SEQUENCE_COUNT * stepCount, sizeof(PlayerInput));
+    for (size_t i = 0; i < HEADLESS_SEQUENCE_COUNT; i++) {
+        makeHeadlessInputSequence(&sequences[i * stepCount], stepCount, 12345u + (uint32_t)i * 7919u);
+    }
+
+    SimJob* jobs = (SimJob*)allocateAgentArray(jobCount, sizeof(SimJob));
+    for (size_t i = 0; i < jobCount; i++) {
+        jobs[i].startPosition = (Vector2){ 2.0f + (float)(i % 13), 10.0f };
+        jobs[i].inputs = &sequences[(i / 13 % HEADLESS_SEQUENCE_COUNT) * stepCount];
+        jobs[i].inputCount = stepCount;
+        jobs[i].world = world;
+    }
+
+    SimResult* singleResults = (SimResult*)allocateAgentArray(jobCount, sizeof(SimResult));
+    SimResult* results = (SimResult*)allocateAgentArray(jobCount, sizeof(SimResult));
+    static SimRunner runner;
+
+    double start = getWallSeconds();
+    runSimJobs(&runner, jobs, jobCount, singleResults, 1, PHYSICS_DELTA);
+    const double singleSeconds = getWallSeconds() - start;
+
+    start = getWallSeconds();
+    runSimJobs(&runner, jobs, jobCount, results, threadCount, PHYSICS_DELTA);
+    const double seconds = getWallSeconds() - start;
+
+    size_t mismatches = 0;
+    unsigned long long jumps = 0;
+    unsigned long long landings = 0;
+    unsigned long long bumps = 0;
+    for (size_t i = 0; i < jobCount; i++) {
+        if (memcmp(&results[i].player.position, &singleResults[i].player.position, sizeof(Vector2)) != 0 ||
+            results[i].jumps != singleResults[i].jumps || results[i].landings != singleResults[i].landings ||
+            results[i].bumps != singleResults[i].bumps) {
+            mismatches++;
+        }
+        jumps += results[i].jumps;
+        landings += results[i].landings;
+        bumps += results[i].bumps;
+    }
+
+    unsigned long long steals = 0;
+    for (int i = 0; i < runner.workerCount; i++) {
+        steals += runner.workers[i].steals;
+    }
+
+    const double steps = (double)jobCount * (double)stepCount;
+    printf("jobs = %zu, steps per job = %zu, threads = %d, steals = %llu\n", jobCount, stepCount, runner.workerCount, steals);
+    printf("1 thread: seconds = %f, jobs/sec = %.0f, steps/sec = %.0f\n", singleSeconds,
+           singleSeconds > 0.0 ? (double)jobCount / singleSeconds : 0.0, singleSeconds > 0.0 ? steps / singleSeconds : 0.0);
+    printf("%d threads: seconds = %f, jobs/sec = %.0f, steps/sec = %.0f\n", runner.workerCount, seconds,
+           seconds > 0.0 ? (double)jobCount / seconds : 0.0, seconds > 0.0 ? steps / seconds : 0.0);
+    printf("jumps = %llu, landings = %llu, bumps = %llu\n", jumps, landings, bumps);
+    printf("mismatches = %zu\n", mismatches);
+
+    free(sequences);
+    free(jobs);
+    free(singleResults);
+    free(results);
+    return mismatches == 0 ? 0 : 1;
+}
+
+int
+main(int argc, const char** argv)
+{
+    size_t agentCount = 0;
+    size_t jobCount = 0;
+    int threadCount = 0;
+    size_t rewindBytes = 0;
+    const char* recordFileName = NULL;
+    const char* replayFileName = NULL;
+    while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+        const unsigned long long value = strtoull(argv[2], NULL, 10);
+        if (strcmp(argv[1], "--record") == 0) {
+            recordFileName = argv[2];
+        } else if (strcmp(argv[1], "--replay") == 0) {
+            replayFileName = argv[2];
+        } else if (strcmp(argv[1], "--agents") == 0) {
+            agentCount = (size_t)value;
+        } else if (strcmp(argv[1], "--jobs") == 0) {
+            jobCount = (size_t)value;
+        } else if (strcmp(argv[1], "--threads") == 0) {
+            threadCount = (int)value;
+        } else if (strcmp(argv[1], "--rewind") == 0) {
+            rewindBytes = (size_t)value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[1]);
+            return 1;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    // A replay runs until the recording ends, so it only takes the level
+    unsigned long long frames = agentCount ? 100000ull : jobCount ? 600ull : rewindBytes ? 300000ull : 10000000ull;
+    const char* levelFileName = NULL;
+    if (replayFileName) {
+        if (argc > 1) levelFileName = argv[1];
+    } else {
+        if (argc > 1) frames = strtoull(argv[1], NULL, 10);
+        if (argc > 2) levelFileName = argv[2];
+    }
+
+    LevelFile levelFile = { 0 };
+    if (levelFileName) {
+        if (!openLevelFile(&levelFile, levelFileName)) {
+            fprintf(stderr, "Can't open level file %s\n", levelFileName);
+            return 1;
+        }
+        useLevelFile(&levelFile);
+    } else {
+        mainTilemap = createTilemap(numOfLevels, &mainTilemapSolids);
+        buildMainTilemapDistances();
+    }
+
+    const WorldSolids world = getWorldSolids();
+    int result = 0;
+    if (replayFileName) {
+        result = runHeadlessReplay(replayFileName, &world);
+    } else if (agentCount) {
+        result = runHeadlessAgents(agentCount, frames, &world);
+    } else if (jobCount) {
+        result = runHeadlessJobs(jobCount, threadCount, frames, &world);
+    } else if (rewindBytes) {
+        result = runHeadlessRewind(rewindBytes, frames, &world, recordFileName);
+    } else {
+        result = runHeadlessBot(frames, &world, recordFileName);
+    }
+
+    if (levelFile.data) {
+        closeLevelFile(&levelFile);
+    } else {
+        freeTilemaps(mainTilemap);
+        freeTilemapSolids(mainTilemapSolids);
+    }
+    freeMainTilemapDistances();
+    return result;
+}
@@ -6,135 +6,62 @@
 
 #include "globals.c"
 #include "tilemap.c"
+#include "collision.c"
 #include "player.c"
+#include "level.c"
+#include "agents.c"
+#include "watch.c"
+#include "input.c"
+#include "record.c"
+#include "events.c"
+#include "rewind.c"
 
 #define VIEW_PIXELS_X (TILEMAP_SIZE_X * TILE_PIXELS)
 #define VIEW_PIXELS_Y (TILEMAP_SIZE_Y * TILE_PIXELS)
 
-
-// Get the screen index, where start = 0 and increases when you move up (-Y)
-int
-getScreenHeightIndex(float height)
-{
-  return floorf(-height / TILEMAP_SIZE_Y);
-}
-
-
-
-// How much should the box in `resolveBoxCollisionWithTilemap` bounce of off walls.
-// Mainly player uses this to bounce.
-#define BOUNCE_FACTOR_X 0.45f
-
-
-// This function takes a box and a tilemap, and tries to make sure the box
-// doesn't intersect with the tilemap.
-//
-// The method:
-// First, we iterate all of the tiles that *could* be colliding with the box (based on the bounding volume).
-// Next, we calculate the distance between near surfaces on each axis.
-// Then we find an axis to 'clip' the position and velocity against.
-//
-// Note: the `size` is half-extent: it's the vector from the center of the box to it's corner.
-//  It's half the actual width and height of the box.
+// Level file loaded at startup, written by `level-pack`
+#define LEVEL_FILE_NAME "levels.jrl"
+// Input of the last session, replay it with `jump-ray-headless --replay`
+#define INPUT_RECORDING_FILE_NAME "last-session.jri"
+// About half an hour of play (a moving player takes ~17 bytes per step)
+#define REWIND_BUFFER_BYTES (2 * 1024 * 1024)
+// Holding the rewind key speeds it up to this many times real time
+#define REWIND_MAX_SPEED 64.0f
+
+#include "assets.c"
+#if defined(EMBED_ASSETS)
+#include ASSET_PACK_HEADER_NAME // Made by `asset-pack --header`
+#endif
+#include "autotile.c"
+#include "atlas.c"
+#include "render.c"
+#include "debug.c"
+#include "preview.c"
+#include "profile.c"
+#include "audio.c"
+#include "ghosts.c"
+
+// Hot reload: a screen of the text level changed on disk
 void
-resolveBoxCollisionWithTilemap(const Tilemap* tilemap, float tilemapHeight, Vector2* center, Vector2* velocity, const Vector2 size)
+onLevelScreenChanged(int screenIndex)
 {
-  // Add the offset to center (simply transform into tilemap local-space)
-  center->y -= tilemapHeight;
-
-  int startX = 0;
-  int startY = 0;
-  int endX = 0;
-  int endY = 0;
-  // Get neighbor tile ranges
-  getTilesOverlappedByBox(&startX, &startY, &endX, &endY, *center, size);
-
-  // Iterate over close tiles
-  for (int x = startX; x <= endX; x++) {
-    for (int y = startY; y <= endY; y++) {
-      // Skip if non-empty
-      if (!tilemapIsTileFull(tilemap, x, y)) continue;
-
-      // Center of the tile box
-      const Vector2 boxPos = { 0.5f + (float)x, 0.5f + (float)y };
-      const Vector2 sizeSum = { size.x + 0.5f, size.y + (float)0.5 };
-      const Vector2 surfDist = {
-        fabsf(center->x - boxPos.x) - sizeSum.x,
-        fabsf(center->y - boxPos.y) - sizeSum.y,
-      };
-
-      // The two boxes aren't colliding, because
-      // the distance between the surfaces is larger than
-      // zero on one of the axes.
-      if (surfDist.x > 0 || surfDist.y > 0) continue;
-
-      // Now check the closer neighboring tiles on each axis.
-      // If the tile is empty (and current tile is full), that means
-      // there exists an edge between the two tiles.
-      // Our box should collide against such an edge.
-      // On the other hand, if there is no edge, the box is inside the tiles
-      // and collision cannot be resolved.
-      const bool isXEmpty = !tilemapIsTileFull(tilemap, x + (center->x > boxPos.x ? 1 : -1), y);
-      // Warning: positive Y is down in this setup!
-      const bool isYEmpty = !tilemapIsTileFull(tilemap, x, y + (center->y > boxPos.y ? 1 : -1));
-
-      // If both neighbors are empty, there aren't any edges to collide against.
-      if (!isXEmpty && !isYEmpty) continue;
-
-      // Clip axis is the axis of an edge which we don't want our box to intersect.
-      bool isClipAxisX = isXEmpty;
-      // In case there are two edges, just get the axis which has the least amount of penetration.
-      if (isXEmpty && isYEmpty) {
-        isClipAxisX = surfDist.x > surfDist.y;
-      }
-
-      if (!player.isOnGround) {
-        PlaySound(bumpWav);
-      }
-
-      // Clip the velocity (or bounce) based on the axis
-      if (isClipAxisX) {
-        if (center->x > boxPos.x) {
-          // Clamp the position exactly to the surface
-          center->x = boxPos.x + sizeSum.x;
-          if (velocity->x < 0.0) {
-            velocity->x = -velocity->x * BOUNCE_FACTOR_X;
-          }
-        } else {
-          center->x = boxPos.x - sizeSum.x;
-          if (velocity->x > 0.0) {
-            velocity->x = -velocity->x * BOUNCE_FACTOR_X;
-          }
-        }
-      } else {
-        if (center->y > boxPos.y) {
-          center->y = boxPos.y + sizeSum.y;
-          velocity->y = fmaxf(velocity->y, 0.0f);
-        } else {
-          center->y = boxPos.y - sizeSum.y;
-          velocity->y = fminf(velocity->y, 0.0f);
-        }
-      }
-
-    } // y
-  } // x
-
-    // Remove the local-space offset
-  center->y += tilemapHeight;
+  invalidateTilemapLayer(screenIndex);
+  invalidateDebugOverlay();
+  invalidateJumpPreview();
 }
 
-// Read inputs and update player movement
-void
-drawSpriteSheetTile(const Texture texture, const int spriteX, const int spriteY, const int spriteSize,
-                    const Vector2 position, const Vector2 scale)
+// The assets compiled into the game, or the asset pack next to the executable.
+// Without either, every asset is loaded (and decoded) from its own file in the working directory.
+bool
+openGameAssets(AssetPack* pack)
 {
-  //    const Vector2 position, const Vector2 scale = { 1, 1 }) {
-  Rectangle r = { (float)(spriteX * spriteSize), (float)(spriteY * spriteSize), (float)spriteSize * scale.x, (float)spriteSize * scale.y };
-  DrawTextureRec(texture,r, position, WHITE);
+#if defined(EMBED_ASSETS)
+  return openAssetPack(pack, (const uint8_t*)embeddedAssetPack, embeddedAssetPackSize, "embedded assets");
+#else
+  return loadAssetPackFile(pack, TextFormat("%s%s", GetApplicationDirectory(), ASSET_PACK_FILE_NAME));
+#endif
 }
 
-
-
 Color BACKGROUND_COLOR = { 15, 5, 45, 255 };
 
 // Entry point of the program
@@ -149,54 +76,146 @@ main(int argc, const char** argv)
   const int initialScreenWidth = TILEMAP_SIZE_X * TILE_PIXELS;
   const int initialScreenHeight = TILEMAP_SIZE_Y * TILE_PIXELS;
 
-  SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+  // Render at the display refresh rate, physics has its own fixed tick (see `PHYSICS_TICK_RATE`)
+  SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_VSYNC_HINT);
   InitWindow(initialScreenWidth * 5, initialScreenHeight * 5, "Jump Ray!");
-  SetTargetFPS(60); // Set our game to run at 60 frames-per-second when possible
   //SetExitKey(KEY_NULL); // Disables ESC key
 
   InitAudioDevice();      // Initialize audio device
 
   bool isDebugEnabled = true;
+  bool isJumpPreviewEnabled = false;
+  bool isProfileGraphEnabled = false;
+  bool isGhostsEnabled = true;
 
   // Vector2 initialPosition = { (float)initialScreenWidth / (2 * TILE_PIXELS), (float)initialScreenHeight / (2 * TILE_PIXELS) };
   Vector2 initialPosition = { 7, 10 };
   player.position = initialPosition;
 
-  Texture playerTexture = LoadTexture("player.png");
-  Texture tilemapTexture = LoadTexture("tilemap.png");
+  AssetPack assets = { 0 };
+  if (!openGameAssets(&assets)) printf("No asset pack, loading the asset files\n");
+  loadSpriteAtlas(&assets);
+  initAutotileTable();
+  loadAutotileTable("tilemap.autotile"); // Optional, for tilesets other than the default one
 
   RenderTexture pixelartRenderTexture = LoadRenderTexture(VIEW_PIXELS_X, VIEW_PIXELS_Y);
+  loadTilemapLayers();
+  loadDebugOverlay();
+
+  loadGameSounds(&assets);
+  closeAssetPack(&assets); // Everything is on the GPU or the audio device now
+
+
+  // A text level given on the command line is watched and reloaded when it changes.
+  // Otherwise use the level file when there is one, or the levels built into tilemap.c
+  LevelFile levelFile = { 0 };
+  TextLevel textLevel = { 0 };
+  FileWatcher textLevelWatcher = { 0 };
+  const bool isTextLevel = argc > 1 && loadTextLevel(&textLevel, argv[1]);
+  if (isTextLevel) {
+    startFileWatcher(&textLevelWatcher, argv[1]);
+    printf("Loaded %zu screens from %s, watching for changes\n", numOfLevels, argv[1]);
+  } else if (openLevelFile(&levelFile, LEVEL_FILE_NAME)) {
+    useLevelFile(&levelFile);
+    printf("Loaded %zu screens from %s\n", numOfLevels, LEVEL_FILE_NAME);
+  } else {
+    mainTilemap = createTilemap(numOfLevels, &mainTilemapSolids);
+    buildMainTilemapDistances();
+    printMap(mainTilemap);
+  }
 
-  jumpWav = LoadSound("jump.wav");
-  bumpWav = LoadSound("bump.wav");
-  floorWav = LoadSound("floor.wav");
-
+  // Fixed timestep state: time not yet simulated, and the player as it was
+  // before the last physics step (for interpolating the drawn position).
+  float physicsAccumulator = 0.0f;
+  Player previousPlayer = player;
+  PlayerInput pendingInput = { 0 };
+  GameEventQueue gameEvents = { 0 };
+  uint32_t physicsStep = 0;
+
+  InputRecorder inputRecorder = { 0 };
+  {
+    const WorldSolids world = getWorldSolids();
+    startInputRecording(&inputRecorder, INPUT_RECORDING_FILE_NAME, &world, player.position);
+    // Recorded runs to race against
+    loadGhosts(GHOST_DIRECTORY, &world);
+    if (ghosts.count > 0) printf("Loaded %zu ghosts from %s\n", ghosts.count, GHOST_DIRECTORY);
+  }
+  bool isPlayerMoved = false; // Set by the debug keys or a rewind, the recording has to know
 
-  mainTilemap = createTilemap(numOfLevels);
-  printMap(mainTilemap);
+  RewindBuffer rewindBuffer;
+  createRewindBuffer(&rewindBuffer, REWIND_BUFFER_BYTES);
+  pushRewindSnapshot(&rewindBuffer, &player);
+  float rewindHeldTime = 0.0f;
+  float rewindSteps = 0.0f; // How far back from the newest snapshot
     
   // Main game loop
   // --------------
   while (!WindowShouldClose()) {
+    beginProfileFrame();
     const float delta = Clamp(GetFrameTime(), 0.0001f, 0.1f);
 
-    int screenIndex = numOfLevels - getScreenHeightIndex(player.position.y) - 2;
-    if (screenIndex < 0 || (size_t)screenIndex > numOfLevels) {
-      screenIndex = 0;
-    }
-
-    const Tilemap* tilemap = &mainTilemap[screenIndex % numOfLevels];
-    const int heightIndex = getScreenHeightIndex(player.position.y);
-    const float screenOffsetY = -(float)(heightIndex + 1) * TILEMAP_SIZE_Y;
-
-        
     // Update
+    beginProfilePhase(PROFILE_UPDATE);
     {
       if (IsKeyPressed(KEY_F)) {ToggleFullscreen(); }
       if (IsKeyPressed(KEY_I)) isDebugEnabled = !isDebugEnabled;
+      if (IsKeyPressed(KEY_P)) isJumpPreviewEnabled = !isJumpPreviewEnabled;
+      if (IsKeyPressed(KEY_G)) isProfileGraphEnabled = !isProfileGraphEnabled;
+      if (IsKeyPressed(KEY_H)) isGhostsEnabled = !isGhostsEnabled;
+      if (IsKeyPressed(KEY_T)) {
+        if (writeProfileTrace(PROFILE_TRACE_FILE_NAME)) printf("Wrote %s\n", PROFILE_TRACE_FILE_NAME);
+        else printf("Can't write %s\n", PROFILE_TRACE_FILE_NAME);
+      }
 
-      updatePlayer(tilemap, screenOffsetY, delta);
-      resolveBoxCollisionWithTilemap(tilemap, screenOffsetY, &player.position, &player.velocity, PLAYER_SIZE);
+      if (isTextLevel && pollFileWatcher(&textLevelWatcher)) {
+        bool isResized = false;
+        const int changed = reloadTextLevel(&textLevel, onLevelScreenChanged, &isResized);
+        if (isResized) {
+          invalidateTilemapLayers();
+          invalidateDebugOverlay();
+          invalidateJumpPreview();
+        }
+        if (changed >= 0) printf("Reloaded %i screens from %s\n", changed, textLevel.fileName);
+      }
+
+      const PlayerInput frameInput = readPlayerInput();
+      accumulatePlayerInput(&pendingInput, &frameInput);
+
+      // Rewind: scrub back through the last steps while the key is held, faster the longer it's held
+      const bool isRewinding = IsKeyDown(KEY_BACKSPACE);
+      if (isRewinding) {
+        rewindHeldTime += delta;
+        const float speed = fminf(powf(2.0f, rewindHeldTime * 2.0f), REWIND_MAX_SPEED);
+        rewindSteps = fminf(rewindSteps + speed * delta * PHYSICS_TICK_RATE, (float)(rewindBuffer.snapshotCount - 1));
+        getRewindSnapshot(&rewindBuffer, (size_t)rewindSteps, &player);
+        previousPlayer = player;
+        physicsAccumulator = 0.0f;
+        pendingInput = (PlayerInput){ 0 };
+      } else if (rewindHeldTime > 0.0f) {
+        // Play on from the rewound step, the steps after it are gone.
+        // The recording gets the whole rewound player, so a replay plays on from the same state.
+        dropNewestRewindSnapshots(&rewindBuffer, (size_t)rewindSteps);
+        rewindHeldTime = 0.0f;
+        rewindSteps = 0.0f;
+        isPlayerMoved = true;
+      }
+
+      const WorldSolids world = getWorldSolids();
+      physicsAccumulator += isRewinding ? 0.0f : delta;
+      while (physicsAccumulator >= PHYSICS_DELTA) {
+        previousPlayer = player;
+        recordPlayerInput(&inputRecorder, &pendingInput, isPlayerMoved ? &player : NULL);
+        isPlayerMoved = false;
+        const PlayerStepResult step = stepPlayer(player, &world, &pendingInput, PHYSICS_DELTA);
+        pushPlayerStepEvents(&gameEvents, step.events, physicsStep++, &player, &step.player);
+        player = step.player;
+        pushRewindSnapshot(&rewindBuffer, &player);
+        stepGhosts(&world);
+
+        consumePlayerInputEdges(&pendingInput);
+        physicsAccumulator -= PHYSICS_DELTA;
+      }
+      dispatchGameEvents(&gameEvents);
 
       // Minimum window size
       if (GetScreenWidth() < VIEW_PIXELS_X) {
@@ -210,158 +229,92 @@ main(int argc, const char** argv)
         // Move screens
         if (IsKeyPressed(KEY_PAGE_UP)) player.position.y -= TILEMAP_SIZE_Y;
         if (IsKeyPressed(KEY_PAGE_DOWN)) player.position.y += TILEMAP_SIZE_Y;
+        if (IsKeyPressed(KEY_PAGE_UP) || IsKeyPressed(KEY_PAGE_DOWN)) {
+          previousPlayer = player;
+          isPlayerMoved = true;
+        }
       }
     }
+    endProfilePhase(PROFILE_UPDATE);
+
+    // Draw the player between the last two physics steps
+    const float interpolation = physicsAccumulator / PHYSICS_DELTA;
+    const Vector2 drawPosition = Vector2Lerp(previousPlayer.position, player.position, interpolation);
+
+    const int screenIndex = getScreenIndex(drawPosition.y);
+    const Tilemap* tilemap = getScreenTilemap(screenIndex);
+    const float screenOffsetY = getScreenOffsetY(drawPosition.y);
+
+    beginProfilePhase(PROFILE_PIXELART);
+    updateTilemapLayers(screenIndex);
 
     // Draw world to pixelart texture
     {
       BeginTextureMode(pixelartRenderTexture);
       ClearBackground(BACKGROUND_COLOR);
 
-      // Draw tilemap
-      for (int x = 0; x < TILEMAP_SIZE_X; x++) {
-        for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
-          if (!tilemapIsTileFull(tilemap, x, y)) continue;
-          // DrawRectangle(x * TILE_PIXELS, y * TILE_PIXELS, TILE_PIXELS, TILE_PIXELS, ORANGE);
-
-          const Tile tile = tilemapGetTileFullOutside(tilemap, x, y);
-          // Neighbors
-          const Tile top = tilemapGetTileFullOutside(tilemap, x, y - 1);
-          const Tile bottom = tilemapGetTileFullOutside(tilemap, x, y + 1);
-          const Tile right = tilemapGetTileFullOutside(tilemap, x + 1, y);
-          const Tile left = tilemapGetTileFullOutside(tilemap, x - 1, y);
-          const Tile topRight = tilemapGetTileFullOutside(tilemap, x + 1, y - 1);
-          const Tile bottomRight = tilemapGetTileFullOutside(tilemap, x + 1, y + 1);
-          const Tile topLeft = tilemapGetTileFullOutside(tilemap, x - 1, y - 1);
-          const Tile bottomLeft = tilemapGetTileFullOutside(tilemap, x - 1, y + 1);
-
-          int spriteX = 0;
-          int spriteY = 0;
-
-          // This logic is bit of a hack...
-          switch (tile) {
-          case TILE_FULL: {
-            spriteX = 1;
-            spriteY = 1;
-            if (top == TILE_FULL) spriteY += 1;
-            if (bottom == TILE_FULL) spriteY -= 1;
-            if (right == TILE_FULL) spriteX -= 1;
-            if (left == TILE_FULL) spriteX += 1;
-
-            if (top != TILE_FULL && bottom != TILE_FULL && right != TILE_FULL && left != TILE_FULL) {
-              spriteX = 3;
-              spriteY = 3;
-            }
-
-            if (left != TILE_FULL && right != TILE_FULL && spriteX == 1) spriteX = 3;
-            if (top != TILE_FULL && bottom != TILE_FULL && spriteY == 1) spriteY = 3;
-
-            if (spriteX == 1 && spriteY == 1) {
-              if (topRight != TILE_FULL && bottomRight == TILE_FULL &&
-                  topLeft == TILE_FULL && bottomLeft == TILE_FULL) {
-                spriteX = 4;
-                spriteY = 2;
-              }
-
-              if (topRight == TILE_FULL && bottomRight != TILE_FULL &&
-                  topLeft == TILE_FULL && bottomLeft == TILE_FULL) {
-                spriteX = 4;
-                spriteY = 0;
-              }
-
-              if (topRight == TILE_FULL && bottomRight == TILE_FULL &&
-                  topLeft != TILE_FULL && bottomLeft == TILE_FULL) {
-                spriteX = 6;
-                spriteY = 2;
-              }
-
-              if (topRight == TILE_FULL && bottomRight == TILE_FULL &&
-                  topLeft == TILE_FULL && bottomLeft != TILE_FULL) {
-                spriteX = 6;
-                spriteY = 0;
-              }
-            }
+      // Draw tilemap (baked once per screen, see `updateTilemapLayers`)
+      drawTilemapLayer(screenIndex);
 
-          }
-            break;
-          case TILE_EMPTY: {
-            break;
-          }
-          case TILE_ZERO: {
-            break;
-          }
-          }
+      // Where the jump being charged would go
+      if (isJumpPreviewEnabled) {
+        drawJumpPreview(getJumpPreviewArc(&player, &pendingInput), screenOffsetY);
+      }
 
-          Vector2 position = { (float)x * TILE_PIXELS, (float)y * TILE_PIXELS };
-          Vector2 scale = { 1, 1 };
-          drawSpriteSheetTile(tilemapTexture, spriteX, spriteY, TILE_PIXELS, position, scale);
-        }
+      if (isGhostsEnabled) {
+        drawGhosts(screenIndex, screenOffsetY, interpolation, delta);
       }
 
       // Draw player, but relative to current screen
       {
-        int sprite = 0;
-
         player.animTime += delta;
 
         // Pick an sprite/animation based on player state
-        if (player.isOnGround) {
-          sprite = 0;
+        const int sprite = getPlayerSprite(&player);
 
-          if (fabsf(player.velocity.x) > 0.01) {
-            sprite = 1 + ((int)floorf(player.animTime * 6.0f)) % 2;
-          }
-
-          if (player.jumpHoldTime > 0.001) {
-            sprite = 4;
-          }
-        } else {
-          sprite = player.velocity.y > 0 ? 5 : 6;
-        }
-
-        Vector2 worldPos = { player.position.x, player.position.y - screenOffsetY };
-        Vector2 someVector = { 8, 10 };
-        Vector2 screenPos = Vector2Subtract(worldToScreen(worldPos), someVector);
+        Vector2 worldPos = { drawPosition.x, drawPosition.y - screenOffsetY };
+        Vector2 screenPos = getPlayerSpritePosition(worldPos);
         Vector2 scale = {(float)(player.isFacingRight ? 1 : -1), 1};
-        drawSpriteSheetTile(playerTexture, sprite, 0, 16, screenPos, scale);
+        drawAtlasSprite(SPRITE_SHEET_PLAYER, sprite, 0, screenPos, scale);
       }
 
       EndTextureMode();
     }
+    endProfilePhase(PROFILE_PIXELART);
 
     // Finalize drawing
 
     {
-      BeginDrawing();
-      ClearBackground(BLACK);
-
       const Vector2 window = { (float)GetScreenWidth(), (float)GetScreenHeight() };
       const float scale = fmaxf(1.0f, floorf(fminf(window.x / VIEW_PIXELS_X, window.y / VIEW_PIXELS_Y)));
       const Vector2 size = { scale * VIEW_PIXELS_X, scale * VIEW_PIXELS_Y };
       const Vector2 offset = Vector2Scale(Vector2Subtract(window, size), 0.5);
 
+      if (isDebugEnabled) {
+        beginProfilePhase(PROFILE_DEBUG);
+        updateDebugOverlay(tilemap, screenIndex, scale, delta, &player, screenOffsetY);
+        endProfilePhase(PROFILE_DEBUG);
+      }
+
+      beginProfilePhase(PROFILE_BLIT);
+      BeginDrawing();
+      ClearBackground(BLACK);
+
       Rectangle source = { 0, 0, (float)pixelartRenderTexture.texture.width, -(float)pixelartRenderTexture.texture.height };
       Rectangle destination = { offset.x, offset.y, size.x, size.y };
       DrawTexturePro(pixelartRenderTexture.texture, source, destination, Vector2Zero(), 0, WHITE);
+      endProfilePhase(PROFILE_BLIT);
 
+      beginProfilePhase(PROFILE_DEBUG);
       if (isDebugEnabled) {
         // Draw tilemap debug info
-        for (int x = 0; x < TILEMAP_SIZE_X; x++) {
-          for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
-            Tile tile = tilemapGetTile(tilemap, x, y);
-            Vector2 worldPos = { (float)x * scale, (float)y * scale };
-            Vector2 textOffset = { 3, 3};
-            DrawTextEx(GetFontDefault(), TextFormat("[%i,%i]\n%i\n\'%c\'", x, y, tile, tile),
-                       Vector2Add(worldToScreen(worldPos), Vector2Add(offset, textOffset)),
-                       10, 1, RED);
-          }
-        }
+        drawDebugTileLabels(offset);
 
         int startX = 0;
         int startY = 0;
         int endX = 0;
         int endY = 0;
-        Vector2 center = { player.position.x, player.position.y - screenOffsetY };
+        Vector2 center = { drawPosition.x, drawPosition.y - screenOffsetY };
         getTilesOverlappedByBox(&startX,
                                 &startY,
                                 &endX,
@@ -382,19 +335,36 @@ main(int argc, const char** argv)
       }
 
       if (isDebugEnabled) {
-        DrawFPS(1, 1);
-        DrawText(TextFormat("player.position = [%f, %f]", player.position.x, player.position.y), 1, 110, 20, WHITE);
-        DrawText(TextFormat("player.jumpHoldTime = %f", player.jumpHoldTime), 1, 88, 20, WHITE);
-        DrawText(TextFormat("screenOffset = %f", screenOffsetY), 1, 22 * 6, 20, WHITE);
-        DrawText(TextFormat("screenIndex = %i", screenIndex), 1, 22 * 7, 20, WHITE);
+        drawDebugHud();
       }
 
+      if (isProfileGraphEnabled) {
+        drawProfileGraph((Vector2){ 1.0f, window.y - 1.0f }, delta);
+      }
+      endProfilePhase(PROFILE_DEBUG);
+
+      beginProfilePhase(PROFILE_PRESENT);
       EndDrawing();
+      endProfilePhase(PROFILE_PRESENT);
     }
   }
 
   // Shutdown
 
+  stopInputRecording(&inputRecorder);
+  freeRewindBuffer(&rewindBuffer);
+  unloadGhosts();
+  unloadGameSounds();
+  unloadDebugOverlay();
+  unloadTilemapLayers();
+  unloadSpriteAtlas();
+  closeLevelFile(&levelFile);
+  freeMainTilemapDistances();
+  if (isTextLevel) {
+    stopFileWatcher(&textLevelWatcher);
+    unloadTextLevel(&textLevel);
+  }
+
   CloseWindow(); // Close window and OpenGL context
 
   return 0;
@@ -396,7 +396,7 @@ void drawSpriteSheetTile(const Texture texture, const int spriteX, const int spr
 
 // Entry point of the program
 // --------------------------
-int main(int argc, const char** argv) {
+int main(int argc, const char** /*argv*/) {
     // Initialization
     // --------------
   printf("argc = %d\n", argc);
@@ -411,30 +411,22 @@ int main(int argc, const char** argv) {
 
     InitAudioDevice();      // Initialize audio device
     
-    // Set the Current Working Directory to the .exe folder.
-    // This is necesarry for loading files shipped relative to the executable.
-    {
-        int numSplit = 0;
-        const char** split = (const char **)TextSplit(argv[0], '\\', &numSplit);
-        const char* path = TextJoin((char **)split, numSplit - 1, "\\");
-        printf("load path = %s\n", path);
-        ChangeDirectory(path);
-    }
-
     bool isDebugEnabled = true;
 
     player.position = {
         (float)initialScreenWidth / (2 * TILE_PIXELS),
         (float)initialScreenHeight / (2 * TILE_PIXELS) };
 
-    Texture playerTexture = LoadTexture("player.png");
-    Texture tilemapTexture = LoadTexture("tilemap.png");
+    // The files are shipped next to the executable, which isn't always the working directory
+    const char* assetDirectory = GetApplicationDirectory();
+    Texture playerTexture = LoadTexture(TextFormat("%s%s", assetDirectory, "player.png"));
+    Texture tilemapTexture = LoadTexture(TextFormat("%s%s", assetDirectory, "tilemap.png"));
 
     RenderTexture pixelartRenderTexture = LoadRenderTexture(VIEW_PIXELS_X, VIEW_PIXELS_Y);
 
-    jumpWav = LoadSound("jump.wav");
-    bumpWav = LoadSound("bump.wav");
-    floorWav = LoadSound("floor.wav");
+    jumpWav = LoadSound(TextFormat("%s%s", assetDirectory, "jump.wav"));
+    bumpWav = LoadSound(TextFormat("%s%s", assetDirectory, "bump.wav"));
+    floorWav = LoadSound(TextFormat("%s%s", assetDirectory, "floor.wav"));
     
     // Main game loop
     // --------------
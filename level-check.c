@@ -0,0 +1,202 @@
+// Checks that a level can be played through: finds platforms that can't be reached from the start
+// and screens that can't be left upwards (see reach.c). With `--watch`, checks a text level again
+// every time it's saved.
+//
+// Usage: level-check [--threads N] [level.jrl]
+//        level-check [--threads N] [--watch] <level.txt>
+
+#define _POSIX_C_SOURCE 200112L // nanosleep
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h" // Vector math (header-only)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+#include <time.h> // nanosleep
+#if defined(_WIN32)
+#include <windows.h> // Sleep
+#endif
+
+#include "globals.c"
+#include "tilemap.c"
+#include "collision.c"
+#include "player.c"
+#include "level.c"
+#include "watch.c"
+#include "runner.c"
+#include "reach.c"
+
+// Where the game puts the player (jump-ray.c)
+#define LEVEL_CHECK_START_POSITION ((Vector2){ 7, 10 })
+
+void
+sleepMilliseconds(int milliseconds)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)milliseconds);
+#else
+    const struct timespec duration = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+    nanosleep(&duration, NULL);
+#endif
+}
+
+// Row of a platform inside its screen, like the rows of a text level
+int
+getReachPlatformRow(const ReachGraph* graph, const ReachPlatform* platform)
+{
+    return platform->y - graph->world.topY - platform->screen * TILEMAP_SIZE_Y;
+}
+
+// Platform the player falls onto from the start position
+int
+findStartPlatform(const ReachGraph* graph)
+{
+    Player sim = player;
+    sim.position = LEVEL_CHECK_START_POSITION;
+    const PlayerInput noInput = { 0 };
+    for (int step = 0; step < REACH_MAX_STEPS; step++) {
+        sim = stepPlayer(sim, &graph->world, &noInput, PHYSICS_DELTA).player;
+        if (sim.isOnGround) return findReachLandingPlatform(graph, sim.position);
+    }
+    return -1;
+}
+
+// Prints the problems of the current level. Returns the number of problems.
+int
+checkLevel(int threadCount)
+{
+    const WorldSolids world = getWorldSolids();
+
+    const double start = getWallSeconds();
+    ReachGraph graph;
+    buildReachGraph(&graph, &world, threadCount);
+    const double seconds = getWallSeconds() - start;
+
+    size_t edgeCount = 0;
+    for (int i = 0; i < graph.screenCount; i++) {
+        edgeCount += graph.screenEdges[i].count;
+    }
+    printf("%d screens, %d platforms, %zu moves between them, %.0f ms\n",
+           graph.screenCount, graph.platformCount, edgeCount, seconds * 1000.0);
+
+    int problems = 0;
+    const int startPlatform = findStartPlatform(&graph);
+    if (startPlatform < 0) {
+        printf("The player doesn't land on anything from the start position\n");
+        freeReachGraph(&graph);
+        return 1;
+    }
+
+    bool* isReachable = (bool*)allocateReachArray((size_t)graph.platformCount, sizeof(bool));
+    findReachablePlatforms(&graph, startPlatform, isReachable);
+
+    for (int i = 0; i < graph.platformCount; i++) {
+        if (isReachable[i]) continue;
+        const ReachPlatform* platform = &graph.platforms[i];
+        printf("screen %d: platform on row %d, columns %d-%d can't be reached\n",
+               platform->screen, getReachPlatformRow(&graph, platform), platform->startX, platform->endX);
+        problems++;
+    }
+
+    // Screens are played bottom to top, reaching the top screen (0) finishes the level
+    for (int screen = graph.screenCount - 1; screen >= 0; screen--) {
+        bool isEntered = false;
+        bool isFinished = false;
+
+        const ReachEdgeList* edges = &graph.screenEdges[screen];
+        for (size_t i = 0; i < edges->count; i++) {
+            const ReachEdge* edge = &edges->edges[i];
+            if (isReachable[edge->from] && graph.platforms[edge->to].screen < screen) isFinished = true;
+        }
+        for (int i = graph.screenFirstPlatform[screen]; i < graph.screenFirstPlatform[screen + 1]; i++) {
+            if (isReachable[i]) isEntered = true;
+        }
+        if (screen == 0) isFinished = true;
+
+        if (!isEntered) {
+            printf("screen %d: never reached\n", screen);
+            problems++;
+        } else if (!isFinished) {
+            printf("screen %d: can't be finished\n", screen);
+            problems++;
+        }
+    }
+
+    printf(problems ? "%d problems\n" : "OK\n", problems);
+
+    free(isReachable);
+    freeReachGraph(&graph);
+    return problems;
+}
+
+int
+main(int argc, const char** argv)
+{
+    int threadCount = 0;
+    bool isWatching = false;
+    while (argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--threads") == 0 && argc > 2) {
+            threadCount = atoi(argv[2]);
+            argc--;
+            argv++;
+        } else if (strcmp(argv[1], "--watch") == 0) {
+            isWatching = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--threads N] [level.jrl]\n       %s [--threads N] [--watch] <level.txt>\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+        argc--;
+        argv++;
+    }
+
+    const char* fileName = argc > 1 ? argv[1] : NULL;
+    const size_t nameLength = fileName ? strlen(fileName) : 0;
+    const bool isLevelFile = nameLength > 4 && strcmp(fileName + nameLength - 4, ".jrl") == 0;
+
+    LevelFile levelFile = { 0 };
+    TextLevel textLevel = { 0 };
+    if (!fileName) {
+        mainTilemap = createTilemap(numOfLevels, &mainTilemapSolids);
+        buildMainTilemapDistances();
+    } else if (isLevelFile) {
+        if (!openLevelFile(&levelFile, fileName)) {
+            fprintf(stderr, "Can't open level file %s\n", fileName);
+            return 1;
+        }
+        useLevelFile(&levelFile);
+    } else if (!loadTextLevel(&textLevel, fileName)) {
+        fprintf(stderr, "Can't read text level %s\n", fileName);
+        return 1;
+    }
+
+    const int problems = checkLevel(threadCount);
+
+    if (isWatching && textLevel.screenHashes) {
+        FileWatcher watcher;
+        startFileWatcher(&watcher, fileName);
+        printf("Watching %s\n", fileName);
+        for (;;) {
+            sleepMilliseconds(100);
+            if (!pollFileWatcher(&watcher)) continue;
+
+            bool isResized = false;
+            if (reloadTextLevel(&textLevel, NULL, &isResized) > 0 || isResized) {
+                printf("\n");
+                checkLevel(threadCount);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (levelFile.data) {
+        closeLevelFile(&levelFile);
+    } else {
+        if (textLevel.screenHashes) unloadTextLevel(&textLevel);
+        freeTilemaps(mainTilemap);
+        freeTilemapSolids(mainTilemapSolids);
+    }
+    freeMainTilemapDistances();
+    return problems ? 1 : 0;
+}
@@ -0,0 +1,614 @@
+// Generates a tall procedural tower as a level file, e.g. 10000 screens to test load time,
+// memory and simulation throughput on more than the handwritten levels.
+//
+// Screens are stored top to bottom and share their boundary rows like the handwritten ones: the
+// last row of a screen is the first row of the screen below it. Each boundary row only depends
+// on the seed and its index, so every screen can be made on its own, in any order, on any
+// thread: the output is the same for a seed whatever the thread count.
+//
+// Every screen is built around a climb the player can make: a ledge over the bottom opening,
+// a zig-zag of ledges at most 3 rows apart (a jump gets ~3.75 tiles high), and a ledge under the
+// top opening to jump out of. Walls and other ledges are added at random around it. The jumps are
+// then simulated like level-check does (reach.c), from everywhere the player can come in to the
+// screen above, and a screen that can't be climbed, or that has a platform the player never gets to,
+// is made again with the next attempt's random numbers. After `LEVEL_GEN_MAX_ATTEMPTS` it's replaced by the climb alone (the template), which
+// `--check-template` simulates for every pair of openings.
+//
+// Simulating the jumps is nearly all of the time: about 25 screens per second per core.
+// Threads take chunks of screens and write them as soon as they're made (level files can be
+// written in any order), so only a few chunks are in memory, never the whole tower.
+//
+// Usage: level-gen [--seed N] [--threads N] <output.jrl> <screens>
+//        level-gen --check-template
+
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h" // Vector math (header-only)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <stdlib.h> // strtoull
+#include <string.h> // strcmp
+
+#include "globals.c"
+#include "tilemap.c"
+#include "collision.c"
+#include "player.c"
+#include "level.c"
+#include "runner.c"
+#include "reach.c"
+
+#define LEVEL_GEN_CHUNK_SCREENS 64
+#define LEVEL_GEN_MAX_ATTEMPTS 64
+// Openings between screens, in tiles
+#define LEVEL_GEN_MIN_OPENING 3
+#define LEVEL_GEN_MAX_OPENING 6
+// Where the game puts the player (jump-ray.c), on the floor of the bottom screen
+#define LEVEL_GEN_START_POSITION ((Vector2){ 7, 10 })
+// Highest ledge above the one the player stands on that a jump gets onto (the apex is ~3.75 tiles),
+// and how many columns apart two ledges of the climb can be
+#define LEVEL_GEN_MAX_RISE 3
+#define LEVEL_GEN_MAX_GAP 2
+// Kept empty above the bottom opening of every screen (rows 9-10, this far beside the opening),
+// so a jump out of the screen below always has the same room to land in
+#define LEVEL_GEN_LANDING_ROW 9
+#define LEVEL_GEN_LANDING_MARGIN 3
+// Rows of the climb, bottom to top: the first ledge, the last one (under the top opening)
+#define LEVEL_GEN_FIRST_ROW 8
+#define LEVEL_GEN_EXIT_ROW 2
+
+typedef struct {
+    uint64_t seed;
+    uint32_t screenCount;
+    LevelFileWriter writer;
+    pthread_mutex_t writerMutex;
+    bool isWriteFailed;
+
+    uint32_t nextChunk; // Taken by the workers with an atomic add
+    uint32_t rejected; // Screens made again because they couldn't be climbed
+    uint32_t templates; // Screens that never could, replaced by the zig-zag template
+} LevelGenerator;
+
+// Most platforms of a screen and the one above it (see `findReachPlatforms`)
+#define LEVEL_GEN_MAX_PLATFORMS (2 * TILEMAP_SIZE_Y * (TILEMAP_SIZE_X + 1) / 2)
+
+// What a worker keeps from one screen check to the next, so checking a screen allocates nothing
+typedef struct {
+    ReachGraph graph;
+    ReachEdgeList edges[LEVEL_GEN_MAX_PLATFORMS]; // Moves from each platform, once it's simulated
+    bool isSimulated[LEVEL_GEN_MAX_PLATFORMS];
+    bool isReached[LEVEL_GEN_MAX_PLATFORMS];
+    int queue[LEVEL_GEN_MAX_PLATFORMS];
+} LevelGenReach;
+
+// Columns [startX, endX] of one row, like `ReachPlatform`
+typedef struct {
+    int y;
+    int startX;
+    int endX; // Inclusive
+} LevelGenLedge;
+
+// SplitMix64: every screen, attempt and boundary gets its own stream from the seed
+uint64_t
+nextLevelGenRandom(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Random number in [min, max]
+int
+levelGenRandomInt(uint64_t* state, int min, int max)
+{
+    return min + (int)(nextLevelGenRandom(state) % (uint64_t)(max - min + 1));
+}
+
+uint64_t
+makeLevelGenRandom(uint64_t seed, uint64_t stream, uint64_t index)
+{
+    uint64_t state = seed ^ (stream * 0xd1b54a32d192ed03ull);
+    state ^= nextLevelGenRandom(&state) + index;
+    nextLevelGenRandom(&state);
+    return state;
+}
+
+// Boundary row `index` is the top row of screen `index` and the bottom row of screen `index - 1`
+// (screens top to bottom). The top of the tower and the floor of the start screen are closed.
+void
+makeLevelGenBoundary(uint64_t seed, uint32_t screenCount, uint32_t index, uint8_t outRow[TILEMAP_SIZE_X + 1])
+{
+    memset(outRow, TILE_FULL, TILEMAP_SIZE_X);
+    outRow[TILEMAP_SIZE_X] = TILE_ZERO;
+    if (index == 0 || index >= screenCount) return;
+
+    uint64_t random = makeLevelGenRandom(seed, 1, index);
+    const int width = levelGenRandomInt(&random, LEVEL_GEN_MIN_OPENING, LEVEL_GEN_MAX_OPENING);
+    // Room to stand on both sides of it
+    const int start = levelGenRandomInt(&random, 1 + LEVEL_GEN_LANDING_MARGIN, TILEMAP_SIZE_X - 1 - LEVEL_GEN_LANDING_MARGIN - width);
+    memset(outRow + start, TILE_EMPTY, (size_t)width);
+}
+
+// The opening of a boundary row, `endX` < `startX` when it's closed
+LevelGenLedge
+getLevelGenOpening(const uint8_t row[TILEMAP_SIZE_X + 1], int y)
+{
+    LevelGenLedge opening = { y, TILEMAP_SIZE_X, -1 };
+    for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+        if (row[x] == TILE_FULL) continue;
+        if (x < opening.startX) opening.startX = x;
+        opening.endX = x;
+    }
+    return opening;
+}
+
+// Sets rows [startY, endY] and columns [startX, endX], clipped to the inside of the screen
+// (boundary rows and outer walls stay as they are)
+void
+fillLevelGenRect(Tilemap* tilemap, int startX, int endX, int startY, int endY, Tile tile)
+{
+    if (startX < 1) startX = 1;
+    if (endX > TILEMAP_SIZE_X - 2) endX = TILEMAP_SIZE_X - 2;
+    if (startY < 1) startY = 1;
+    if (endY > TILEMAP_SIZE_Y - 2) endY = TILEMAP_SIZE_Y - 2;
+    for (int y = startY; y <= endY; y++) {
+        for (int x = startX; x <= endX; x++) {
+            (*tilemap)[y][x] = (uint8_t)tile;
+        }
+    }
+}
+
+// Whether the player can jump from a ledge onto a higher one beside it. A jump that high only
+// gets above the higher ledge after moving sideways a bit, so the lower one has to reach at least
+// 3 columns past the near edge of the higher one.
+bool
+isLevelGenLedgeNear(LevelGenLedge lower, LevelGenLedge upper)
+{
+    if (upper.startX > lower.endX) {
+        return upper.startX >= lower.startX + 3 && upper.startX <= lower.endX + 1 + LEVEL_GEN_MAX_GAP;
+    }
+    if (upper.endX < lower.startX) {
+        return upper.endX <= lower.endX - 3 && upper.endX >= lower.startX - 1 - LEVEL_GEN_MAX_GAP;
+    }
+    return false;
+}
+
+// Ledges of the climb between the first and the exit ledge, zig-zagging so every one is near the
+// ones above and below it. Rows 8, 5, 2 (one ledge between) or 8, 6, 4, 2 (two).
+// Picks one at random, or the first one found for the template. Returns how many it placed, -1 if none fit.
+int
+pickLevelGenClimb(LevelGenLedge first, LevelGenLedge exitLedge, int between, uint64_t* random, bool isTemplate,
+                  LevelGenLedge outLedges[2])
+{
+    LevelGenLedge candidates[TILEMAP_SIZE_X * 2][2];
+    int count = 0;
+    const int step = (first.y - exitLedge.y) / (between + 1);
+    for (int x1 = 1; x1 < TILEMAP_SIZE_X - 1; x1++) {
+        for (int length1 = 2; length1 <= 3; length1++) {
+            const LevelGenLedge a = { first.y - step, x1, x1 + length1 - 1 };
+            if (a.endX > TILEMAP_SIZE_X - 2 || !isLevelGenLedgeNear(first, a)) continue;
+            if (between == 1) {
+                if (!isLevelGenLedgeNear(a, exitLedge)) continue;
+                candidates[count][0] = a;
+                count++;
+                continue;
+            }
+            // With two ledges between, one second ledge per first one is enough choice
+            for (int x2 = 1; x2 < TILEMAP_SIZE_X - 1; x2++) {
+                const LevelGenLedge b = { a.y - step, x2, x2 + 1 };
+                if (b.endX > TILEMAP_SIZE_X - 2 || !isLevelGenLedgeNear(a, b) || !isLevelGenLedgeNear(b, exitLedge)) continue;
+                candidates[count][0] = a;
+                candidates[count][1] = b;
+                count++;
+                break;
+            }
+        }
+    }
+    if (count == 0) return -1;
+
+    const int pick = isTemplate ? 0 : levelGenRandomInt(random, 0, count - 1);
+    for (int i = 0; i < between; i++) {
+        outLedges[i] = candidates[pick][i];
+    }
+    return between;
+}
+
+// A screen built around a climb: a first ledge over the bottom opening (reached from either side
+// of it), a zig-zag of ledges, and an exit ledge under the top opening to jump out of. Around that
+// there are walls and ledges at random, unless it's the template, then there's nothing else.
+// Returns false when the ledges of the climb don't fit.
+bool
+makeLevelGenCandidate(const uint8_t top[TILEMAP_SIZE_X + 1], const uint8_t bottom[TILEMAP_SIZE_X + 1],
+                      uint64_t* random, bool isTemplate, Tilemap* outTilemap)
+{
+    const LevelGenLedge topOpening = getLevelGenOpening(top, 0);
+    const LevelGenLedge bottomOpening = getLevelGenOpening(bottom, TILEMAP_SIZE_Y - 1);
+    const bool isTopScreen = topOpening.endX < topOpening.startX;
+    const bool isBottomScreen = bottomOpening.endX < bottomOpening.startX;
+
+    for (int y = 1; y < TILEMAP_SIZE_Y - 1; y++) {
+        memset((*outTilemap)[y], TILE_EMPTY, TILEMAP_SIZE_X);
+        (*outTilemap)[y][TILEMAP_SIZE_X] = TILE_ZERO;
+        (*outTilemap)[y][0] = TILE_FULL;
+        (*outTilemap)[y][TILEMAP_SIZE_X - 1] = TILE_FULL;
+    }
+    memcpy((*outTilemap)[0], top, TILEMAP_SIZE_X + 1);
+    memcpy((*outTilemap)[TILEMAP_SIZE_Y - 1], bottom, TILEMAP_SIZE_X + 1);
+
+    // First ledge: inside the columns of the bottom opening, so both sides of it can jump on it
+    LevelGenLedge first = { LEVEL_GEN_FIRST_ROW, bottomOpening.startX + 1, bottomOpening.endX - 1 };
+    if (isBottomScreen) {
+        const int length = isTemplate ? 3 : levelGenRandomInt(random, 2, 4);
+        first.startX = isTemplate ? 2 : levelGenRandomInt(random, 1, TILEMAP_SIZE_X - 1 - length);
+        first.endX = first.startX + length - 1;
+    }
+
+    // Exit ledge: two tiles under the top opening, the player jumps out towards the side with more room
+    // (the top screen has no way out, its last ledge is just as high)
+    const LevelGenLedge opening = isTopScreen ? (LevelGenLedge){ 0, 4, 11 } : topOpening;
+    const int leftRoom = opening.startX - 1;
+    const int rightRoom = TILEMAP_SIZE_X - 2 - opening.endX;
+    bool isExitRight = rightRoom >= leftRoom;
+    if (!isTemplate && leftRoom >= 2 && rightRoom >= 2) isExitRight = levelGenRandomInt(random, 0, 1) == 1;
+    LevelGenLedge exitLedge = { LEVEL_GEN_EXIT_ROW, opening.startX + 1, opening.startX + 2 };
+    if (isExitRight) exitLedge = (LevelGenLedge){ LEVEL_GEN_EXIT_ROW, opening.endX - 2, opening.endX - 1 };
+
+    // The first ledge, the ones between and the exit ledge
+    LevelGenLedge ledges[4] = { first };
+    const int between = isTemplate ? 1 : levelGenRandomInt(random, 1, 2);
+    int count = pickLevelGenClimb(first, exitLedge, between, random, isTemplate, &ledges[1]);
+    if (count < 0) count = pickLevelGenClimb(first, exitLedge, 3 - between, random, isTemplate, &ledges[1]);
+    if (count < 0) return false;
+    ledges[count + 1] = exitLedge;
+    const int ledgeCount = count + 2;
+
+    if (!isTemplate) {
+        // Walls that get thicker and thinner going up, now and then: every step is a platform
+        // that has to be reached, and another few hundred moves to simulate
+        int left = levelGenRandomInt(random, 1, 3);
+        int right = levelGenRandomInt(random, 1, 3);
+        for (int y = 1; y < TILEMAP_SIZE_Y - 1; y++) {
+            if (levelGenRandomInt(random, 0, 3) == 0) left = (int)Clamp((float)(left + levelGenRandomInt(random, -1, 1)), 1.0f, 3.0f);
+            if (levelGenRandomInt(random, 0, 3) == 0) right = (int)Clamp((float)(right + levelGenRandomInt(random, -1, 1)), 1.0f, 3.0f);
+            memset((*outTilemap)[y], TILE_FULL, (size_t)left);
+            memset((*outTilemap)[y] + TILEMAP_SIZE_X - right, TILE_FULL, (size_t)right);
+        }
+        // A few short ledges that aren't part of the climb
+        const int extraCount = levelGenRandomInt(random, 0, 3);
+        for (int i = 0; i < extraCount; i++) {
+            const int y = levelGenRandomInt(random, 3, LEVEL_GEN_FIRST_ROW + 1);
+            const int x = levelGenRandomInt(random, 1, TILEMAP_SIZE_X - 3);
+            fillLevelGenRect(outTilemap, x, x + levelGenRandomInt(random, 0, 1), y, y, TILE_FULL);
+        }
+    }
+
+    // Room to jump from every ledge of the climb to the next, to land from the screen below,
+    // and to stand at the start
+    for (int i = 0; i < ledgeCount; i++) {
+        const LevelGenLedge* ledge = &ledges[i];
+        fillLevelGenRect(outTilemap, ledge->startX - LEVEL_GEN_MAX_GAP - 1, ledge->endX + LEVEL_GEN_MAX_GAP + 1,
+                         ledge->y - LEVEL_GEN_MAX_RISE, ledge->y - 1, TILE_EMPTY);
+    }
+    fillLevelGenRect(outTilemap, first.startX - LEVEL_GEN_MAX_GAP - 1, first.endX + LEVEL_GEN_MAX_GAP + 1,
+                     first.y + 1, TILEMAP_SIZE_Y - 2, TILE_EMPTY);
+    if (isBottomScreen) {
+        const int startX = (int)LEVEL_GEN_START_POSITION.x;
+        fillLevelGenRect(outTilemap, startX - 1, startX + 1, LEVEL_GEN_LANDING_ROW, TILEMAP_SIZE_Y - 2, TILE_EMPTY);
+    } else {
+        fillLevelGenRect(outTilemap, bottomOpening.startX - LEVEL_GEN_LANDING_MARGIN, bottomOpening.endX + LEVEL_GEN_LANDING_MARGIN,
+                         LEVEL_GEN_LANDING_ROW, TILEMAP_SIZE_Y - 2, TILE_EMPTY);
+    }
+    for (int i = 0; i < ledgeCount; i++) {
+        fillLevelGenRect(outTilemap, ledges[i].startX, ledges[i].endX, ledges[i].y, ledges[i].y, TILE_FULL);
+    }
+    return true;
+}
+
+// What a screen knows of the one above it: the shared boundary row, and the empty rows every
+// screen keeps above its bottom opening. Everything else is full, so a jump that gets out into
+// it also gets out into the real one.
+void
+makeLevelGenScreenAbove(const uint8_t top[TILEMAP_SIZE_X + 1], Tilemap* outTilemap)
+{
+    for (int y = 0; y < TILEMAP_SIZE_Y - 1; y++) {
+        memset((*outTilemap)[y], TILE_FULL, TILEMAP_SIZE_X);
+        (*outTilemap)[y][TILEMAP_SIZE_X] = TILE_ZERO;
+    }
+    memcpy((*outTilemap)[TILEMAP_SIZE_Y - 1], top, TILEMAP_SIZE_X + 1);
+
+    const LevelGenLedge opening = getLevelGenOpening(top, TILEMAP_SIZE_Y - 1);
+    if (opening.endX < opening.startX) return;
+    fillLevelGenRect(outTilemap, opening.startX - LEVEL_GEN_LANDING_MARGIN, opening.endX + LEVEL_GEN_LANDING_MARGIN,
+                     LEVEL_GEN_LANDING_ROW, TILEMAP_SIZE_Y - 2, TILE_EMPTY);
+}
+
+void
+freeLevelGenReach(LevelGenReach* reach)
+{
+    for (int i = 0; i < LEVEL_GEN_MAX_PLATFORMS; i++) {
+        free(reach->edges[i].edges);
+    }
+    if (reach->graph.screenEdges) freeReachGraph(&reach->graph);
+    memset(reach, 0, sizeof(*reach));
+}
+
+// Marks the platforms the player gets to from `start` in `reach->isReached`. Moves are simulated
+// with reach.c, only from the platforms that are reached, and kept for the next start.
+// The screen above (screen 0) is where the climb ends, moves from it aren't followed.
+void
+findLevelGenReachedPlatforms(LevelGenReach* reach, int start)
+{
+    const ReachGraph* graph = &reach->graph;
+    memset(reach->isReached, 0, (size_t)graph->platformCount * sizeof(bool));
+    int queueStart = 0;
+    int queueEnd = 0;
+    reach->queue[queueEnd++] = start;
+    reach->isReached[start] = true;
+
+    while (queueStart < queueEnd) {
+        const int platform = reach->queue[queueStart++];
+        if (graph->platforms[platform].screen == 0) continue;
+
+        if (!reach->isSimulated[platform]) {
+            simulateReachPlatform(graph, platform, &reach->edges[platform]);
+            reach->isSimulated[platform] = true;
+        }
+        for (size_t i = 0; i < reach->edges[platform].count; i++) {
+            const int to = reach->edges[platform].edges[i].to;
+            if (reach->isReached[to]) continue;
+            reach->isReached[to] = true;
+            reach->queue[queueEnd++] = to;
+        }
+    }
+}
+
+// Whether, from `start`, the player gets to the goal (any platform of the screen above, or `goal`
+// when it's not -1) and to every platform of the screen, like level-check wants
+bool
+isLevelGenClimbableFrom(LevelGenReach* reach, int start, int goal)
+{
+    const ReachGraph* graph = &reach->graph;
+    findLevelGenReachedPlatforms(reach, start);
+
+    bool isGoalReached = goal >= 0 && reach->isReached[goal];
+    for (int i = graph->screenFirstPlatform[0]; i < graph->screenFirstPlatform[1] && goal < 0; i++) {
+        if (reach->isReached[i]) isGoalReached = true;
+    }
+    if (!isGoalReached) return false;
+    for (int i = graph->screenFirstPlatform[1]; i < graph->screenFirstPlatform[2]; i++) {
+        if (!reach->isReached[i]) return false;
+    }
+    return true;
+}
+
+// Whether a screen can be climbed from everywhere the player can come in (the start position on
+// the bottom screen, the boundary beside the bottom opening otherwise) to the screen above,
+// or to the exit ledge on the top screen, with every platform of it reached on the way.
+// Simulates the jumps like level-check.
+bool
+isLevelGenScreenClimbable(LevelGenReach* reach, const Tilemap* tilemap, const uint8_t top[TILEMAP_SIZE_X + 1])
+{
+    Tilemap above;
+    makeLevelGenScreenAbove(top, &above);
+    TilemapSolids solids[2];
+    tilemapComputeSolids(&above, &solids[0]);
+    tilemapComputeSolids(tilemap, &solids[1]);
+
+    // The graph's arrays are kept from the last screen, see `findReachPlatforms`
+    ReachGraph* graph = &reach->graph;
+    graph->world = makeWorldSolids(solids, 2);
+    graph->screenCount = 2;
+    findReachPlatforms(graph);
+    if (!graph->screenEdges) graph->screenEdges = (ReachEdgeList*)allocateReachArray(2, sizeof(ReachEdgeList));
+    for (int i = 0; i < graph->platformCount; i++) {
+        reach->edges[i].count = 0;
+        reach->isSimulated[i] = false;
+    }
+
+    // The bottom screen is at the same place as in the game, see `makeWorldSolids`
+    const int bottomY = graph->world.topY + graph->world.rowCount - 1;
+    const LevelGenLedge bottomOpening = getLevelGenOpening((*tilemap)[TILEMAP_SIZE_Y - 1], bottomY);
+    const LevelGenLedge topOpening = getLevelGenOpening(top, 0);
+    const bool isBottomScreen = bottomOpening.endX < bottomOpening.startX;
+
+    // The top screen's goal is its highest ledge, it has no way out
+    int goal = -1;
+    if (topOpening.endX < topOpening.startX) {
+        for (int x = 1; x < TILEMAP_SIZE_X - 1 && goal < 0; x++) {
+            goal = getReachPlatform(graph, x, bottomY - (TILEMAP_SIZE_Y - 1 - LEVEL_GEN_EXIT_ROW));
+        }
+        if (goal < 0) return false;
+    }
+
+    if (isBottomScreen) {
+        Player sim = player;
+        sim.position = LEVEL_GEN_START_POSITION;
+        const PlayerInput noInput = { 0 };
+        int start = -1;
+        for (int step = 0; step < REACH_MAX_STEPS && start < 0; step++) {
+            sim = stepPlayer(sim, &graph->world, &noInput, PHYSICS_DELTA).player;
+            if (sim.isOnGround) start = findReachLandingPlatform(graph, sim.position);
+        }
+        return start >= 0 && isLevelGenClimbableFrom(reach, start, goal);
+    }
+
+    // Every platform of the boundary where a jump from below can land
+    int last = -1;
+    for (int x = bottomOpening.startX - LEVEL_GEN_LANDING_MARGIN; x <= bottomOpening.endX + LEVEL_GEN_LANDING_MARGIN; x++) {
+        const int start = getReachPlatform(graph, x, bottomY);
+        if (start < 0 || start == last) continue;
+        last = start;
+        if (!isLevelGenClimbableFrom(reach, start, goal)) return false;
+    }
+    return true;
+}
+
+// Screen `index` (top to bottom): tries climbs with other random numbers until one can be
+// climbed, then falls back to the template
+void
+makeLevelGenScreen(LevelGenerator* generator, LevelGenReach* reach, uint32_t index, Tilemap* outTilemap)
+{
+    uint8_t top[TILEMAP_SIZE_X + 1];
+    uint8_t bottom[TILEMAP_SIZE_X + 1];
+    makeLevelGenBoundary(generator->seed, generator->screenCount, index, top);
+    makeLevelGenBoundary(generator->seed, generator->screenCount, index + 1, bottom);
+
+    for (int attempt = 0; attempt < LEVEL_GEN_MAX_ATTEMPTS; attempt++) {
+        uint64_t random = makeLevelGenRandom(generator->seed, 2, (uint64_t)index * LEVEL_GEN_MAX_ATTEMPTS + (uint64_t)attempt);
+        if (makeLevelGenCandidate(top, bottom, &random, false, outTilemap) && isLevelGenScreenClimbable(reach, outTilemap, top)) {
+            if (attempt > 0) __atomic_fetch_add(&generator->rejected, (uint32_t)attempt, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    __atomic_fetch_add(&generator->rejected, LEVEL_GEN_MAX_ATTEMPTS, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&generator->templates, 1, __ATOMIC_RELAXED);
+    makeLevelGenCandidate(top, bottom, NULL, true, outTilemap);
+}
+
+void*
+runLevelGenWorker(void* data)
+{
+    LevelGenerator* generator = (LevelGenerator*)data;
+    Tilemap tilemaps[LEVEL_GEN_CHUNK_SCREENS];
+    LevelGenReach* reach = (LevelGenReach*)allocateReachArray(1, sizeof(LevelGenReach));
+    for (;;) {
+        const uint32_t chunk = __atomic_fetch_add(&generator->nextChunk, 1, __ATOMIC_RELAXED);
+        const uint64_t first = (uint64_t)chunk * LEVEL_GEN_CHUNK_SCREENS;
+        if (first >= generator->screenCount) break;
+        const uint32_t count = (uint32_t)(generator->screenCount - first < LEVEL_GEN_CHUNK_SCREENS
+                                          ? generator->screenCount - first : LEVEL_GEN_CHUNK_SCREENS);
+
+        for (uint32_t i = 0; i < count; i++) {
+            makeLevelGenScreen(generator, reach, (uint32_t)first + i, &tilemaps[i]);
+        }
+
+        pthread_mutex_lock(&generator->writerMutex);
+        for (uint32_t i = 0; i < count && !generator->isWriteFailed; i++) {
+            if (!writeLevelFileScreen(&generator->writer, (uint32_t)first + i, &tilemaps[i])) generator->isWriteFailed = true;
+        }
+        pthread_mutex_unlock(&generator->writerMutex);
+    }
+    freeLevelGenReach(reach);
+    free(reach);
+    return NULL;
+}
+
+// Simulates the template for every pair of openings a tower can have (and the closed top and
+// bottom), returns how many can't be climbed
+int
+checkLevelGenTemplate(void)
+{
+    int failed = 0;
+    int count = 0;
+    LevelGenReach* reach = (LevelGenReach*)allocateReachArray(1, sizeof(LevelGenReach));
+    for (int top = -1; top <= TILEMAP_SIZE_X; top++) {
+        for (int bottom = -1; bottom <= TILEMAP_SIZE_X; bottom++) {
+            for (int width = LEVEL_GEN_MIN_OPENING; width <= LEVEL_GEN_MAX_OPENING; width++) {
+                for (int topWidth = LEVEL_GEN_MIN_OPENING; topWidth <= LEVEL_GEN_MAX_OPENING; topWidth++) {
+                    // -1 is closed, once whatever the width
+                    if ((top < 0 && topWidth > LEVEL_GEN_MIN_OPENING) || (bottom < 0 && width > LEVEL_GEN_MIN_OPENING)) continue;
+                    if (top >= 0 && (top < 1 + LEVEL_GEN_LANDING_MARGIN || top + topWidth > TILEMAP_SIZE_X - 1 - LEVEL_GEN_LANDING_MARGIN)) continue;
+                    if (bottom >= 0 && (bottom < 1 + LEVEL_GEN_LANDING_MARGIN || bottom + width > TILEMAP_SIZE_X - 1 - LEVEL_GEN_LANDING_MARGIN)) continue;
+
+                    uint8_t topRow[TILEMAP_SIZE_X + 1];
+                    uint8_t bottomRow[TILEMAP_SIZE_X + 1];
+                    memset(topRow, TILE_FULL, TILEMAP_SIZE_X);
+                    memset(bottomRow, TILE_FULL, TILEMAP_SIZE_X);
+                    topRow[TILEMAP_SIZE_X] = TILE_ZERO;
+                    bottomRow[TILEMAP_SIZE_X] = TILE_ZERO;
+                    if (top >= 0) memset(topRow + top, TILE_EMPTY, (size_t)topWidth);
+                    if (bottom >= 0) memset(bottomRow + bottom, TILE_EMPTY, (size_t)width);
+
+                    Tilemap tilemap;
+                    count++;
+                    if (makeLevelGenCandidate(topRow, bottomRow, NULL, true, &tilemap) && isLevelGenScreenClimbable(reach, &tilemap, topRow)) continue;
+                    failed++;
+                    printf("; can't be climbed\n");
+                    printLevel(&tilemap, 0);
+                }
+            }
+        }
+    }
+    freeLevelGenReach(reach);
+    free(reach);
+    printf("%d of %d templates can't be climbed\n", failed, count);
+    return failed;
+}
+
+// Reads the level file back and counts the stacked screens whose shared rows differ
+uint32_t
+countLevelGenMisalignedScreens(const char* fileName)
+{
+    LevelFile level;
+    if (!openLevelFile(&level, fileName)) return UINT32_MAX;
+    uint32_t misaligned = 0;
+    for (uint32_t i = 0; i + 1 < level.header->screenCount; i++) {
+        if (memcmp(level.tiles[i][TILEMAP_SIZE_Y - 1], level.tiles[i + 1][0], TILEMAP_SIZE_X) != 0) misaligned++;
+    }
+    closeLevelFile(&level);
+    return misaligned;
+}
+
+int
+main(int argc, const char** argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--check-template") == 0) return checkLevelGenTemplate() == 0 ? 0 : 1;
+
+    const char* programName = argv[0];
+    uint64_t seed = 1;
+    int threadCount = 0;
+    while (argc > 1 && strncmp(argv[1], "--", 2) == 0 && argc > 2) {
+        if (strcmp(argv[1], "--seed") == 0) {
+            seed = strtoull(argv[2], NULL, 10);
+        } else if (strcmp(argv[1], "--threads") == 0) {
+            threadCount = atoi(argv[2]);
+        } else {
+            break;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+    const unsigned long long screenCount = argc == 3 ? strtoull(argv[2], NULL, 10) : 0;
+    if (argc != 3 || strncmp(argv[1], "--", 2) == 0 || screenCount == 0 || screenCount > UINT32_MAX) {
+        fprintf(stderr, "Usage: %s [--seed N] [--threads N] <output.jrl> <screens>\n       %s --check-template\n", programName, programName);
+        return 1;
+    }
+    const char* fileName = argv[1];
+
+    LevelGenerator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.seed = seed;
+    generator.screenCount = (uint32_t)screenCount;
+    if (!beginLevelFile(&generator.writer, fileName, generator.screenCount)) return 1;
+    pthread_mutex_init(&generator.writerMutex, NULL);
+
+    if (threadCount <= 0) threadCount = getCpuCount();
+    if (threadCount > SIM_MAX_THREADS) threadCount = SIM_MAX_THREADS;
+
+    const double start = getWallSeconds();
+    pthread_t threads[SIM_MAX_THREADS];
+    for (int i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[i], NULL, runLevelGenWorker, &generator) != 0) {
+            fprintf(stderr, "Failed to start level generator thread!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    runLevelGenWorker(&generator);
+    for (int i = 1; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    const bool isWritten = endLevelFile(&generator.writer) && !generator.isWriteFailed;
+    const double seconds = getWallSeconds() - start;
+    pthread_mutex_destroy(&generator.writerMutex);
+    if (!isWritten) {
+        fprintf(stderr, "Failed to write %s\n", fileName);
+        return 1;
+    }
+
+    const uint32_t misaligned = countLevelGenMisalignedScreens(fileName);
+    printf("Wrote %u screens to %s (seed %llu)\n", generator.screenCount, fileName, (unsigned long long)seed);
+    printf("threads = %d, seconds = %f, screens/sec = %.0f\n", threadCount, seconds,
+           seconds > 0.0 ? (double)generator.screenCount / seconds : 0.0);
+    printf("rejected = %u, templates = %u, misaligned = %u\n", generator.rejected, generator.templates, misaligned);
+    return misaligned == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Writes the built-in levels (tilemap.c) or a text level into a binary level file,
+// or prints a level file as a text level.
+//
+// Usage: level-pack <output.jrl> [level.txt]
+//        level-pack --print <level.jrl>
+
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h" // Vector math (header-only)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h> // printf
+#include <string.h> // strcmp
+
+#include "globals.c"
+#include "tilemap.c"
+#include "level.c"
+
+int
+main(int argc, const char** argv)
+{
+    if (argc == 3 && strcmp(argv[1], "--print") == 0) {
+        LevelFile level;
+        if (!openLevelFile(&level, argv[2])) {
+            fprintf(stderr, "Can't open level file %s\n", argv[2]);
+            return 1;
+        }
+        printf("; %s: version %u, %u screens\n", argv[2], level.header->version, level.header->screenCount);
+        for (uint32_t i = 0; i < level.header->screenCount; i++) {
+            printf("; screen %u (hash %08x)\n", i, level.screens[i].hash);
+            printLevel(level.tiles, i);
+        }
+        closeLevelFile(&level);
+        return 0;
+    }
+
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "Usage: %s <output.jrl> [level.txt]\n       %s --print <level.jrl>\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    Tilemap* tilemaps = NULL;
+    if (argc == 3) {
+        uint32_t* hashes = NULL;
+        tilemaps = parseTextLevel(argv[2], &numOfLevels, &hashes);
+        if (!tilemaps) {
+            fprintf(stderr, "Can't read text level %s\n", argv[2]);
+            return 1;
+        }
+        free(hashes);
+        mainTilemapSolids = NULL;
+    } else {
+        tilemaps = createTilemap(numOfLevels, &mainTilemapSolids);
+    }
+    if (!writeLevelFile(argv[1], tilemaps, numOfLevels)) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        return 1;
+    }
+    printf("Wrote %zu screens to %s\n", numOfLevels, argv[1]);
+
+    freeTilemaps(tilemaps);
+    freeTilemapSolids(mainTilemapSolids);
+    return 0;
+}
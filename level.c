@@ -0,0 +1,539 @@
+
+// Binary level file (*.jrl), so levels don't have to be compiled into the game.
+//
+// Layout (native byte order):
+//   LevelFileHeader
+//   LevelFileScreen index[screenCount]
+//   Tilemap         tiles[screenCount]   at `header.tilesOffset`
+//   TilemapSolids   solids[screenCount]  at `header.solidsOffset`
+//
+// Screens are stored top to bottom, same as `mainTilemap`, and the tiles and collision
+// layers are stored exactly as they are in memory. The file is memory-mapped and
+// `mainTilemap`/`mainTilemapSolids` point straight into the mapping, so opening even a huge
+// level is instant and only the screens that are actually visited get read from disk.
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap
+#include <unistd.h> // close
+#endif
+
+#define LEVEL_FILE_MAGIC "JRLV"
+#define LEVEL_FILE_VERSION 1
+// Sections start at multiples of this
+#define LEVEL_FILE_ALIGNMENT 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t screenCount;
+    uint32_t tilemapBytes; // sizeof(Tilemap) of the writer, the layout must match
+    uint64_t indexOffset;
+    uint64_t tilesOffset;
+    uint64_t solidsOffset;
+} LevelFileHeader;
+
+typedef struct {
+    uint64_t tilesOffset;
+    uint64_t solidsOffset;
+    uint32_t hash; // `hashTilemap` of the screen's tiles
+    uint32_t reserved;
+} LevelFileScreen;
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    bool isMapped; // false when the file was read into memory instead
+    const LevelFileHeader* header;
+    const LevelFileScreen* screens;
+    Tilemap* tiles;
+    TilemapSolids* solids;
+} LevelFile;
+
+typedef struct {
+    FILE* file;
+    LevelFileHeader header;
+} LevelFileWriter;
+
+// FNV-1a hash of a screen's tiles, used to tell whether a screen changed
+uint32_t
+hashTilemap(const Tilemap* tilemap)
+{
+    const uint8_t* bytes = (const uint8_t*)tilemap;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(Tilemap); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint64_t
+alignLevelFileOffset(uint64_t offset)
+{
+    return (offset + LEVEL_FILE_ALIGNMENT - 1) / LEVEL_FILE_ALIGNMENT * LEVEL_FILE_ALIGNMENT;
+}
+
+LevelFileHeader
+makeLevelFileHeader(uint32_t screenCount)
+{
+    LevelFileHeader header = { 0 };
+    memcpy(header.magic, LEVEL_FILE_MAGIC, 4);
+    header.version = LEVEL_FILE_VERSION;
+    header.screenCount = screenCount;
+    header.tilemapBytes = sizeof(Tilemap);
+    header.indexOffset = alignLevelFileOffset(sizeof(LevelFileHeader));
+    header.tilesOffset = alignLevelFileOffset(header.indexOffset + (uint64_t)screenCount * sizeof(LevelFileScreen));
+    header.solidsOffset = alignLevelFileOffset(header.tilesOffset + (uint64_t)screenCount * sizeof(Tilemap));
+    return header;
+}
+
+// Check that the header and the index make sense for a file of `size` bytes
+bool
+validateLevelFile(const uint8_t* data, size_t size, const char* fileName)
+{
+    if (size < sizeof(LevelFileHeader)) {
+        fprintf(stderr, "%s: not a level file (too small)\n", fileName);
+        return false;
+    }
+
+    const LevelFileHeader* header = (const LevelFileHeader*)data;
+    if (memcmp(header->magic, LEVEL_FILE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not a level file\n", fileName);
+        return false;
+    }
+    if (header->version != LEVEL_FILE_VERSION || header->tilemapBytes != sizeof(Tilemap)) {
+        fprintf(stderr, "%s: unsupported level file version %u\n", fileName, header->version);
+        return false;
+    }
+
+    const LevelFileHeader expected = makeLevelFileHeader(header->screenCount);
+    if (header->screenCount == 0 ||
+        header->indexOffset != expected.indexOffset ||
+        header->tilesOffset != expected.tilesOffset ||
+        header->solidsOffset != expected.solidsOffset ||
+        size < expected.solidsOffset + (uint64_t)header->screenCount * sizeof(TilemapSolids)) {
+        fprintf(stderr, "%s: broken level file header\n", fileName);
+        return false;
+    }
+
+    const LevelFileScreen* screens = (const LevelFileScreen*)(data + header->indexOffset);
+    for (uint32_t i = 0; i < header->screenCount; i++) {
+        if (screens[i].tilesOffset != header->tilesOffset + (uint64_t)i * sizeof(Tilemap) ||
+            screens[i].solidsOffset != header->solidsOffset + (uint64_t)i * sizeof(TilemapSolids)) {
+            fprintf(stderr, "%s: broken index entry for screen %u\n", fileName, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+closeLevelFile(LevelFile* level)
+{
+    if (!level->data) return;
+#if defined(_WIN32)
+    free(level->data);
+#else
+    if (level->isMapped) munmap(level->data, level->size);
+#endif
+    memset(level, 0, sizeof(*level));
+}
+
+// Open and map a level file. Returns false (with a message on stderr) if it can't be used.
+// The mapping is private: changing tiles in memory (e.g. when reloading a screen) never writes to the file.
+bool
+openLevelFile(LevelFile* level, const char* fileName)
+{
+    memset(level, 0, sizeof(*level));
+
+#if defined(_WIN32)
+    // No mmap here, just read the whole file
+    FILE* file = fopen(fileName, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize <= 0) {
+        fclose(file);
+        return false;
+    }
+    level->size = (size_t)fileSize;
+    level->data = (uint8_t*)malloc(level->size);
+    if (!level->data) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    const bool isRead = fread(level->data, 1, level->size, file) == level->size;
+    fclose(file);
+    if (!isRead) {
+        free(level->data);
+        level->data = NULL;
+        return false;
+    }
+#else
+    const int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    level->size = (size_t)st.st_size;
+    void* data = mmap(NULL, level->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed\n", fileName);
+        return false;
+    }
+    level->data = (uint8_t*)data;
+    level->isMapped = true;
+#endif
+
+    if (!validateLevelFile(level->data, level->size, fileName)) {
+        closeLevelFile(level);
+        return false;
+    }
+
+    level->header = (const LevelFileHeader*)level->data;
+    level->screens = (const LevelFileScreen*)(level->data + level->header->indexOffset);
+    level->tiles = (Tilemap*)(level->data + level->header->tilesOffset);
+    level->solids = (TilemapSolids*)(level->data + level->header->solidsOffset);
+    return true;
+}
+
+// Make the level file the current level (`mainTilemap` etc.)
+void
+useLevelFile(const LevelFile* level)
+{
+    mainTilemap = level->tiles;
+    mainTilemapSolids = level->solids;
+    numOfLevels = level->header->screenCount;
+    buildMainTilemapDistances();
+}
+
+// Collision view of a level file without making it the main level, e.g. for simulations on worker threads
+WorldSolids
+getLevelFileWorldSolids(const LevelFile* level)
+{
+    return makeWorldSolids(level->solids, level->header->screenCount);
+}
+
+// Level files are written one screen at a time, so a level never has to be in memory as a whole.
+// Screens can be written in any order, every index in [0, screenCount) must be written once.
+bool
+beginLevelFile(LevelFileWriter* writer, const char* fileName, uint32_t screenCount)
+{
+    writer->header = makeLevelFileHeader(screenCount);
+    writer->file = fopen(fileName, "wb");
+    if (!writer->file) {
+        fprintf(stderr, "%s: can't open for writing\n", fileName);
+        return false;
+    }
+    return fwrite(&writer->header, sizeof(writer->header), 1, writer->file) == 1;
+}
+
+bool
+writeLevelFileScreen(LevelFileWriter* writer, uint32_t index, const Tilemap* tilemap)
+{
+    if (index >= writer->header.screenCount) return false;
+
+    TilemapSolids solids;
+    tilemapComputeSolids(tilemap, &solids);
+
+    LevelFileScreen screen = { 0 };
+    screen.tilesOffset = writer->header.tilesOffset + (uint64_t)index * sizeof(Tilemap);
+    screen.solidsOffset = writer->header.solidsOffset + (uint64_t)index * sizeof(TilemapSolids);
+    screen.hash = hashTilemap(tilemap);
+
+    FILE* file = writer->file;
+    bool isOk = true;
+    isOk = isOk && fseek(file, (long)(writer->header.indexOffset + (uint64_t)index * sizeof(LevelFileScreen)), SEEK_SET) == 0;
+    isOk = isOk && fwrite(&screen, sizeof(screen), 1, file) == 1;
+    isOk = isOk && fseek(file, (long)screen.tilesOffset, SEEK_SET) == 0;
+    isOk = isOk && fwrite(tilemap, sizeof(Tilemap), 1, file) == 1;
+    isOk = isOk && fseek(file, (long)screen.solidsOffset, SEEK_SET) == 0;
+    isOk = isOk && fwrite(&solids, sizeof(TilemapSolids), 1, file) == 1;
+    return isOk;
+}
+
+bool
+endLevelFile(LevelFileWriter* writer)
+{
+    const bool isOk = fflush(writer->file) == 0;
+    return (fclose(writer->file) == 0) && isOk;
+}
+
+// Write an array of screens (top to bottom) as a level file
+bool
+writeLevelFile(const char* fileName, const Tilemap* tilemaps, size_t count)
+{
+    LevelFileWriter writer;
+    if (!beginLevelFile(&writer, fileName, (uint32_t)count)) return false;
+
+    bool isOk = true;
+    for (size_t i = 0; i < count && isOk; i++) {
+        isOk = writeLevelFileScreen(&writer, (uint32_t)i, &tilemaps[i]);
+    }
+    return endLevelFile(&writer) && isOk;
+}
+
+
+// Text levels, for editing levels while the game runs.
+//
+// A text level is a list of screens from top to bottom. Each screen is `TILEMAP_SIZE_Y` lines of
+// `TILEMAP_SIZE_X` tiles, using the same characters as the strings in tilemap.c ('#' solid, ' ' empty).
+// Empty lines are skipped and lines starting with ';' are comments, so screens can be separated
+// freely. Note: a row of only empty tiles must keep its spaces. Short rows are padded with empty tiles.
+//
+// `level-pack --print` writes this format.
+
+typedef struct {
+    const char* start;
+    const char* end;
+} LevelTextScreen;
+
+typedef struct {
+    char fileName[256];
+    uint32_t* screenHashes; // Hash of each screen's text, to find the screens that changed on reload
+    size_t screenCount;
+} TextLevel;
+
+// Read a whole text file, null-terminated. Returns NULL if it can't be read.
+char*
+loadLevelTextFile(const char* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (!file) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    char* text = (char*)malloc((size_t)fileSize + 1);
+    if (!text) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    const size_t length = fread(text, 1, (size_t)fileSize, file);
+    text[length] = '\0';
+    fclose(file);
+    return text;
+}
+
+// Length of the line starting at `line` without the line break
+size_t
+levelTextLineLength(const char* line, const char** outNext)
+{
+    const char* end = strchr(line, '\n');
+    if (!end) end = line + strlen(line);
+    *outNext = *end ? end + 1 : end;
+
+    size_t length = (size_t)(end - line);
+    if (length > 0 && line[length - 1] == '\r') length--;
+    return length;
+}
+
+bool
+isLevelTextRow(const char* line, size_t length)
+{
+    return length > 0 && line[0] != ';';
+}
+
+// Find where each screen is in the text. Returns the number of screens,
+// writes at most `maxScreens` of them to `outScreens` (can be NULL to just count).
+size_t
+splitLevelText(const char* text, LevelTextScreen* outScreens, size_t maxScreens)
+{
+    size_t count = 0;
+    int rows = 0;
+    const char* screenStart = text;
+
+    const char* line = text;
+    while (*line) {
+        const char* next = NULL;
+        const size_t length = levelTextLineLength(line, &next);
+        if (isLevelTextRow(line, length)) {
+            if (rows == 0) screenStart = line;
+            rows++;
+            if (rows == TILEMAP_SIZE_Y) {
+                if (count < maxScreens) {
+                    outScreens[count].start = screenStart;
+                    outScreens[count].end = next;
+                }
+                count++;
+                rows = 0;
+            }
+        }
+        line = next;
+    }
+
+    // Unfinished screen at the end, gets padded with empty rows
+    if (rows > 0) {
+        if (count < maxScreens) {
+            outScreens[count].start = screenStart;
+            outScreens[count].end = line;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+uint32_t
+hashLevelTextScreen(const LevelTextScreen* screen)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* c = screen->start; c < screen->end; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+void
+parseLevelTextScreen(const LevelTextScreen* screen, Tilemap* outTilemap)
+{
+    memset(outTilemap, TILE_EMPTY, sizeof(Tilemap));
+
+    int y = 0;
+    const char* line = screen->start;
+    while (line < screen->end && *line && y < TILEMAP_SIZE_Y) {
+        const char* next = NULL;
+        size_t length = levelTextLineLength(line, &next);
+        if (isLevelTextRow(line, length)) {
+            if (length > TILEMAP_SIZE_X) length = TILEMAP_SIZE_X;
+            memcpy((*outTilemap)[y], line, length);
+            y++;
+        }
+        line = next;
+    }
+
+    for (y = 0; y < TILEMAP_SIZE_Y; y++) {
+        (*outTilemap)[y][TILEMAP_SIZE_X] = '\0';
+    }
+}
+
+// Parse a whole text level into a new array of screens. Returns NULL when the file can't be read
+// or has no screens, and stores the hash of each screen's text in `outHashes` (allocated here).
+Tilemap*
+parseTextLevel(const char* fileName, size_t* outCount, uint32_t** outHashes)
+{
+    char* text = loadLevelTextFile(fileName);
+    if (!text) return NULL;
+
+    const size_t count = splitLevelText(text, NULL, 0);
+    if (count == 0) {
+        fprintf(stderr, "%s: no screens\n", fileName);
+        free(text);
+        return NULL;
+    }
+
+    LevelTextScreen* screens = (LevelTextScreen*)malloc(count * sizeof(LevelTextScreen));
+    uint32_t* hashes = (uint32_t*)malloc(count * sizeof(uint32_t));
+    if (!screens || !hashes) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    Tilemap* tilemaps = allocateTilemaps(count);
+
+    splitLevelText(text, screens, count);
+    for (size_t i = 0; i < count; i++) {
+        parseLevelTextScreen(&screens[i], &tilemaps[i]);
+        hashes[i] = hashLevelTextScreen(&screens[i]);
+    }
+
+    free(screens);
+    free(text);
+    *outCount = count;
+    *outHashes = hashes;
+    return tilemaps;
+}
+
+// Load a text level as the current level (`mainTilemap` etc.)
+bool
+loadTextLevel(TextLevel* level, const char* fileName)
+{
+    size_t count = 0;
+    uint32_t* hashes = NULL;
+    Tilemap* tilemaps = parseTextLevel(fileName, &count, &hashes);
+    if (!tilemaps) return false;
+
+    reloadTilemap(tilemaps, count);
+    freeTilemaps(tilemaps);
+
+    snprintf(level->fileName, sizeof(level->fileName), "%s", fileName);
+    level->screenHashes = hashes;
+    level->screenCount = count;
+    return true;
+}
+
+void
+unloadTextLevel(TextLevel* level)
+{
+    free(level->screenHashes);
+    level->screenHashes = NULL;
+    level->screenCount = 0;
+}
+
+// Read the text level again and update only the screens whose text changed.
+// `onScreenChanged` (can be NULL) is called with the index of every updated screen,
+// so the caller can rebuild whatever it keeps per screen.
+// When screens were added or removed all of them are replaced, and `outIsResized` is set.
+// Returns the number of updated screens, or -1 when the file can't be read.
+int
+reloadTextLevel(TextLevel* level, void (*onScreenChanged)(int screenIndex), bool* outIsResized)
+{
+    *outIsResized = false;
+
+    char* text = loadLevelTextFile(level->fileName);
+    if (!text) return -1;
+
+    const size_t count = splitLevelText(text, NULL, 0);
+    if (count == 0) {
+        // Probably caught the file in the middle of being saved, keep what we have
+        free(text);
+        return -1;
+    }
+
+    if (count != level->screenCount) {
+        free(text);
+        unloadTextLevel(level);
+        char fileName[sizeof(level->fileName)];
+        memcpy(fileName, level->fileName, sizeof(fileName));
+        if (!loadTextLevel(level, fileName)) return -1;
+        *outIsResized = true;
+        return (int)level->screenCount;
+    }
+
+    LevelTextScreen* screens = (LevelTextScreen*)malloc(count * sizeof(LevelTextScreen));
+    if (!screens) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    splitLevelText(text, screens, count);
+
+    int changed = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t hash = hashLevelTextScreen(&screens[i]);
+        if (hash == level->screenHashes[i]) continue;
+
+        Tilemap tilemap;
+        parseLevelTextScreen(&screens[i], &tilemap);
+        insertLevelInMap(&tilemap, mainTilemap, mainTilemapSolids, i);
+        updateMainTilemapDistances((int)i);
+        level->screenHashes[i] = hash;
+        changed++;
+        if (onScreenChanged) onScreenChanged((int)i);
+    }
+
+    free(screens);
+    free(text);
+    return changed;
+}
@@ -1,3 +1,4 @@
+
 // Gravity in units (tiles) per second
 #define PLAYER_GRAVITY 30.0f
 
@@ -5,6 +6,8 @@
 #define PLAYER_SPEED 200.0f
 #define PLAYER_GROUND_FRICTION_X 70.0f
 #define PLAYER_JUMP_STRENGTH 15.0f
+// Velocity is clamped to this length (tiles per second)
+#define PLAYER_MAX_SPEED 25.0f
 
 typedef struct {
     Vector2 position;
@@ -17,131 +20,181 @@ typedef struct {
 
 Player player = { {0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, 0.0f, false, false};
 
+// Physics runs at a fixed rate, independent of the rendering frame rate.
+// Note: walking speed is tuned per step (see `PLAYER_SPEED`), so changing the
+// tick rate changes how the game feels.
+#define PHYSICS_TICK_RATE 60
+#define PHYSICS_DELTA (1.0f / PHYSICS_TICK_RATE)
+
+// The jump strength only changes for hold times in [1.1, 2.0] / 2.6 seconds (see `applyPlayerGroundInput`),
+// so holding the jump for fewer/more physics steps than these gives the same jump.
+#define PLAYER_JUMP_MIN_HOLD_STEPS (11 * PHYSICS_TICK_RATE / 26)
+#define PLAYER_JUMP_MAX_HOLD_STEPS (20 * PHYSICS_TICK_RATE / 26 + 1)
+#define PLAYER_JUMP_HOLD_STEP_COUNT (PLAYER_JUMP_MAX_HOLD_STEPS - PLAYER_JUMP_MIN_HOLD_STEPS + 1)
+
 // Half-size of the player's box collider.
 Vector2 PLAYER_SIZE = {0.3f, 0.4f};
+// Half-size of the box under the player's feet, that checks if there's ground.
+Vector2 PLAYER_GROUND_PROBE_SIZE = {0.1f, 0.05f};
 
+// Snapshot of the controls for one simulation step.
+// The game fills it from keyboard/gamepad (see input.c), bots and tools fill it themselves.
+typedef struct {
+    bool isJumpDown;
+    bool isJumpReleased;
+    bool isRightDown;
+    bool isLeftDown;
+    // Any direction was pressed this step (restarts the walk animation)
+    bool isMovePressed;
+    // Gamepad left stick, already dead-zoned. Only used when `isGamepad` is set.
+    bool isGamepad;
+    float stickX;
+} PlayerInput;
+
+// Things that happened during a simulation step, as bit flags.
+// Physics doesn't play sounds itself, the caller decides what to do with these.
+typedef enum {
+    PLAYER_EVENT_NONE = 0,
+    PLAYER_EVENT_JUMP = 1 << 0,
+    PLAYER_EVENT_LAND = 1 << 1,
+    PLAYER_EVENT_BUMP = 1 << 2,
+} PlayerEvent;
 
+typedef struct {
+    Player player;
+    int events; // `PlayerEvent` flags
+} PlayerStepResult;
 
-// Checks whether the box is intersecting any tile in the tilemap.
-// param `tilemap`: tilemap to check
-// param `tilemapHeight`: offset of the tilemap along the Y axis
-// param `center`: coordinate of the center of the box
-// param `size`: half-extent of the box - half the box sides
-bool
-isBoxCollidingWithTilemap(const Tilemap* tilemap, float tilemapHeight, Vector2 center, const Vector2 size)
+// Accumulate a frame's input into the input for the next physics step.
+// Held buttons take the latest state, but presses/releases are kept until a step consumes them,
+// so they aren't lost on frames where no physics step runs.
+void
+accumulatePlayerInput(PlayerInput* pending, const PlayerInput* frame)
 {
-    center.y -= tilemapHeight;
-
-    int startX = 0;
-    int startY = 0;
-    int endX = 0;
-    int endY = 0;
-    // Get neighbor tile ranges
-    getTilesOverlappedByBox(&startX, &startY, &endX, &endY, center, size);
-
-    // Iterate over close tiles
-    for (int x = startX; x <= endX; x++) {
-        for (int y = startY; y <= endY; y++) {
-            // Skip if non-empty
-            if (!tilemapIsTileFull(tilemap, x, y)) continue;
-
-            // Center of the tile box
-            const Vector2 boxPos = { 0.5f + (float)x, 0.5f + (float)y };
-            const Vector2 sizeSum = { size.x + 0.5f, size.y + 0.5f };
-            const Vector2 surfDist = {
-                fabsf(center.x - boxPos.x) - sizeSum.x,
-                fabsf(center.y - boxPos.y) - sizeSum.y,
-            };
-
-            // The two boxes aren't colliding, because
-            // the distance between the surfaces is larger than
-            // zero on one of the axes.
-            if (surfDist.x > 0 || surfDist.y > 0) continue;
-            return true;
-        } // y
-    } // x
-
-    return false;
+    const bool isJumpReleased = pending->isJumpReleased || frame->isJumpReleased;
+    const bool isMovePressed = pending->isMovePressed || frame->isMovePressed;
+    *pending = *frame;
+    pending->isJumpReleased = isJumpReleased;
+    pending->isMovePressed = isMovePressed;
 }
 
+// Forget presses/releases once a physics step has seen them
 void
-updatePlayer(const Tilemap* tilemap, float tilemapHeight, float delta)
+consumePlayerInputEdges(PlayerInput* input)
 {
-    player.velocity.y += PLAYER_GRAVITY * delta;
-
-    Vector2 center = { player.position.x, player.position.y + PLAYER_SIZE.y };
-    Vector2 size = { 0.1, 0.05 };
-    const bool isOnGround = isBoxCollidingWithTilemap(tilemap, tilemapHeight, center, size);
-    // { player->position.x, player->position.y + PLAYER_SIZE.y },
-    // { 0.1, 0.05 });
-    if (isOnGround && !player.isOnGround) {
-        PlaySound(floorWav);
-    }
-    player.isOnGround = isOnGround;
+    input->isJumpReleased = false;
+    input->isMovePressed = false;
+}
 
-    if (isOnGround) {
-        player.velocity.x = 0;
-
-        const float leftStickDeadzoneX = 0.1f;
-        const float leftStickDeadzoneY = 0.1f;
-        float leftStickX;
-        float leftStickY;
-
-        if (IsGamepadAvailable(0)) {
-            printf("Gamepad Available\n");
-            leftStickX = GetGamepadAxisMovement(0, GAMEPAD_AXIS_LEFT_X);
-            leftStickY = GetGamepadAxisMovement(0, GAMEPAD_AXIS_LEFT_Y);
-            if (leftStickX > -leftStickDeadzoneX && leftStickX < leftStickDeadzoneX) leftStickX = 0.0f;
-            if (leftStickY > -leftStickDeadzoneY && leftStickY < leftStickDeadzoneY) leftStickY = 0.0f;
-        }
+bool
+isPlayerInputRight(const PlayerInput* input)
+{
+    return input->isRightDown || (input->isGamepad && input->stickX >= 0.0f);
+}
 
+bool
+isPlayerInputLeft(const PlayerInput* input)
+{
+    return input->isLeftDown || (input->isGamepad && input->stickX <= 0.0f);
+}
 
-        if (IsKeyReleased(KEY_SPACE) ||
-                IsGamepadAvailable(0) && IsGamepadButtonReleased(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN)) {
-            PlaySound(jumpWav);
-            // Calculate strength based on how long the user held down the jump key.
-            // The numbers are kind of random, you play with it yourself.
-            const float jumpStrength = Clamp(player.jumpHoldTime * 2.6f, 1.1f, 2.0f) / 2.0f;
-
-            // If the player doesn't press anything, the direction is up.
-            Vector2 dir = { 0.0f, -1.0f };
-            const float xMoveStrength = 0.75f - (jumpStrength * 0.5f);
-            if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D) || IsGamepadAvailable(0) && leftStickX >= 0.0f) dir.x += xMoveStrength;
-            if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A) ||  IsGamepadAvailable(0) && leftStickX <= -0.0f) dir.x -= xMoveStrength;
-            // Make sure the vector is unit vector (length = 1.0).
-            dir = Vector2Normalize(dir);
-
-            // Multiply the vector length by the strength factor.
-            dir = Vector2Scale(dir, jumpStrength * PLAYER_JUMP_STRENGTH);
-            // Now apply the jump vector to the actual velocity
-            player.velocity = dir;
+// Jumping and walking, only while the player stands on the ground.
+// Returns `PlayerEvent` flags.
+int
+applyPlayerGroundInput(Player* player, const PlayerInput* input, float delta)
+{
+    int events = PLAYER_EVENT_NONE;
+
+    player->velocity.x = 0;
+
+    if (input->isJumpReleased) {
+        events |= PLAYER_EVENT_JUMP;
+        // Calculate strength based on how long the user held down the jump key.
+        // The numbers are kind of random, you play with it yourself.
+        const float jumpStrength = Clamp(player->jumpHoldTime * 2.6f, 1.1f, 2.0f) / 2.0f;
+
+        // If the player doesn't press anything, the direction is up.
+        Vector2 dir = { 0.0f, -1.0f };
+        const float xMoveStrength = 0.75f - (jumpStrength * 0.5f);
+        if (isPlayerInputRight(input)) dir.x += xMoveStrength;
+        if (isPlayerInputLeft(input)) dir.x -= xMoveStrength;
+        // Make sure the vector is unit vector (length = 1.0).
+        dir = Vector2Normalize(dir);
+
+        // Multiply the vector length by the strength factor.
+        dir = Vector2Scale(dir, jumpStrength * PLAYER_JUMP_STRENGTH);
+        // Now apply the jump vector to the actual velocity
+        player->velocity = dir;
+    }
+    if (input->isJumpDown) {
+        player->jumpHoldTime += delta;
+    } else {
+        player->jumpHoldTime = 0.0f;
+        if (isPlayerInputRight(input)) {
+            player->velocity.x += PLAYER_SPEED * delta;
+            player->isFacingRight = true;
         }
-        if (IsKeyDown(KEY_SPACE) ||
-                IsGamepadAvailable(0) && IsGamepadButtonDown(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN)) {
-            player.jumpHoldTime += delta;
-        } else {
-            player.jumpHoldTime = 0.0f;
-            if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D) || IsGamepadAvailable(0) && leftStickX >= 0.0f) {
-                player.velocity.x += PLAYER_SPEED * delta;
-                player.isFacingRight = true;
-            }
-            if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A) || IsGamepadAvailable(0) && leftStickX <= 0.0f) {
-                player.velocity.x -= PLAYER_SPEED * delta;
-                player.isFacingRight = false;
-            }
-
-            if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_D) || IsKeyPressed(KEY_A)) {
-                player.animTime = 0;
-            }
+        if (isPlayerInputLeft(input)) {
+            player->velocity.x -= PLAYER_SPEED * delta;
+            player->isFacingRight = false;
         }
+
+        if (input->isMovePressed) {
+            player->animTime = 0;
+        }
+    }
+
+    return events;
+}
+
+// Apply input, gravity and jumping to the player and integrate the position.
+// Returns `PlayerEvent` flags.
+int
+updatePlayer(Player* player, const WorldSolids* world, const PlayerInput* input, float delta)
+{
+    int events = PLAYER_EVENT_NONE;
+
+    player->velocity.y += PLAYER_GRAVITY * delta;
+
+    Vector2 center = { player->position.x, player->position.y + PLAYER_SIZE.y };
+    const bool isOnGround = isBoxCollidingWithTilemap(world, center, PLAYER_GROUND_PROBE_SIZE);
+    if (isOnGround && !player->isOnGround) {
+        events |= PLAYER_EVENT_LAND;
+    }
+    player->isOnGround = isOnGround;
+
+    if (isOnGround) {
+        events |= applyPlayerGroundInput(player, input, delta);
     } else {
-        player.jumpHoldTime = 0.0f;
+        player->jumpHoldTime = 0.0f;
     }
 
     // Clamp velocity
-    float vel = Vector2Length(player.velocity);
-    if (vel > 25.0) vel = 25.0;
-    player.velocity = Vector2Scale(Vector2Normalize(player.velocity), vel);
+    float vel = Vector2Length(player->velocity);
+    if (vel > PLAYER_MAX_SPEED) vel = PLAYER_MAX_SPEED;
+    player->velocity = Vector2Scale(Vector2Normalize(player->velocity), vel);
+
+    // Move, but don't let a long step carry the player through a wall
+    const Vector2 motion = limitBoxMotion(world, player->position, PLAYER_SIZE, Vector2Scale(player->velocity, delta));
+    player->position = Vector2Add(player->position, motion);
+
+    return events;
+}
+
+// One full physics step: movement followed by collision resolution.
+// Doesn't touch any globals (other than reading the collision layer), so it can be
+// called from the game, from headless tools, or for many players at once.
+PlayerStepResult
+stepPlayer(Player player, const WorldSolids* world, const PlayerInput* input, float delta)
+{
+    PlayerStepResult result = { player, PLAYER_EVENT_NONE };
+
+    result.events |= updatePlayer(&result.player, world, input, delta);
+    const bool isClipped = resolveBoxCollisionWithTilemap(world,
+                                                          &result.player.position, &result.player.velocity, PLAYER_SIZE);
+    if (isClipped && !result.player.isOnGround) {
+        result.events |= PLAYER_EVENT_BUMP;
+    }
 
-    player.position = Vector2Add(player.position, Vector2Scale(player.velocity, delta));
+    return result;
 }
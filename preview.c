@@ -0,0 +1,149 @@
+
+// Jump preview: while the jump is charged, draw where the jump would go if it was released now.
+//
+// The arc depends only on where the player stands, the hold time (in physics steps, only
+// `PLAYER_JUMP_HOLD_STEP_COUNT` of them are different jumps) and the direction. So arcs are
+// simulated once with `stepPlayer` and kept in a table per standing position, and drawing
+// the preview is a lookup. Each arc is filled the first time it's needed.
+
+#define JUMP_PREVIEW_CACHE_SIZE 4
+#define JUMP_PREVIEW_MAX_STEPS (PHYSICS_TICK_RATE * 3)
+// An arc point every few physics steps
+#define JUMP_PREVIEW_POINT_STEPS 2
+#define JUMP_PREVIEW_MAX_POINTS (JUMP_PREVIEW_MAX_STEPS / JUMP_PREVIEW_POINT_STEPS + 2)
+#define JUMP_PREVIEW_MAX_BOUNCES 4
+
+typedef struct {
+  Vector2 points[JUMP_PREVIEW_MAX_POINTS];
+  Vector2 bounces[JUMP_PREVIEW_MAX_BOUNCES]; // Where it hit a wall or ceiling (`BOUNCE_FACTOR_X`)
+  uint8_t pointCount;
+  uint8_t bounceCount;
+  bool isLanding; // The last point is where it lands
+  bool isValid;
+} JumpArc;
+
+// Every arc from one standing position: [direction + 1][hold steps - PLAYER_JUMP_MIN_HOLD_STEPS]
+typedef struct {
+  Vector2 position;
+  uint32_t lastUsed;
+  bool isUsed;
+  JumpArc arcs[3][PLAYER_JUMP_HOLD_STEP_COUNT];
+} JumpArcTable;
+
+typedef struct {
+  JumpArcTable tables[JUMP_PREVIEW_CACHE_SIZE];
+  uint32_t useCounter;
+} JumpPreview;
+
+JumpPreview jumpPreview;
+
+// The level changed, every arc may be different now
+void
+invalidateJumpPreview(void)
+{
+  for (int i = 0; i < JUMP_PREVIEW_CACHE_SIZE; i++) {
+    jumpPreview.tables[i].isUsed = false;
+  }
+}
+
+void
+simulateJumpArc(JumpArc* arc, const WorldSolids* world, Player sim, int holdSteps, int direction)
+{
+  memset(arc, 0, sizeof(*arc));
+  arc->isValid = true;
+  arc->points[arc->pointCount++] = sim.position;
+
+  // Same as letting go of the jump key on the next physics step
+  sim.jumpHoldTime = (float)holdSteps * PHYSICS_DELTA;
+  PlayerInput input = { 0 };
+  input.isJumpReleased = true;
+  input.isRightDown = direction > 0;
+  input.isLeftDown = direction < 0;
+
+  for (int step = 0; step < JUMP_PREVIEW_MAX_STEPS; step++) {
+    const PlayerStepResult result = stepPlayer(sim, world, &input, PHYSICS_DELTA);
+    sim = result.player;
+    input = (PlayerInput){ 0 };
+
+    if ((result.events & PLAYER_EVENT_BUMP) && arc->bounceCount < JUMP_PREVIEW_MAX_BOUNCES) {
+      arc->bounces[arc->bounceCount++] = sim.position;
+    }
+    if (step > 0 && (result.events & PLAYER_EVENT_LAND)) {
+      arc->points[arc->pointCount++] = sim.position;
+      arc->isLanding = true;
+      return;
+    }
+    if (step % JUMP_PREVIEW_POINT_STEPS == JUMP_PREVIEW_POINT_STEPS - 1) {
+      arc->points[arc->pointCount++] = sim.position;
+    }
+  }
+}
+
+// Table of the position the player stands at, the least recently used one is reused on a miss
+JumpArcTable*
+findJumpArcTable(const Player* standing)
+{
+  JumpArcTable* oldest = &jumpPreview.tables[0];
+  for (int i = 0; i < JUMP_PREVIEW_CACHE_SIZE; i++) {
+    JumpArcTable* table = &jumpPreview.tables[i];
+    if (table->isUsed && table->position.x == standing->position.x && table->position.y == standing->position.y) {
+      return table;
+    }
+    if (!table->isUsed || (oldest->isUsed && table->lastUsed < oldest->lastUsed)) oldest = table;
+  }
+
+  oldest->isUsed = true;
+  oldest->position = standing->position;
+  for (int direction = 0; direction < 3; direction++) {
+    for (int hold = 0; hold < PLAYER_JUMP_HOLD_STEP_COUNT; hold++) {
+      oldest->arcs[direction][hold].isValid = false;
+    }
+  }
+  return oldest;
+}
+
+// Arc of the jump the player is charging, NULL when not charging
+const JumpArc*
+getJumpPreviewArc(const Player* standing, const PlayerInput* input)
+{
+  if (!standing->isOnGround || standing->jumpHoldTime <= 0.0f || !input->isJumpDown) return NULL;
+
+  int holdSteps = (int)roundf(standing->jumpHoldTime / PHYSICS_DELTA);
+  holdSteps = (int)Clamp((float)holdSteps, (float)PLAYER_JUMP_MIN_HOLD_STEPS, (float)PLAYER_JUMP_MAX_HOLD_STEPS);
+  const int direction = (isPlayerInputRight(input) ? 1 : 0) - (isPlayerInputLeft(input) ? 1 : 0);
+
+  JumpArcTable* table = findJumpArcTable(standing);
+  table->lastUsed = ++jumpPreview.useCounter;
+
+  JumpArc* arc = &table->arcs[direction + 1][holdSteps - PLAYER_JUMP_MIN_HOLD_STEPS];
+  if (!arc->isValid) {
+    const WorldSolids world = getWorldSolids();
+    simulateJumpArc(arc, &world, *standing, holdSteps, direction);
+  }
+  return arc;
+}
+
+// Draws into the pixel art texture, `screenOffsetY` as for the player sprite
+void
+drawJumpPreview(const JumpArc* arc, float screenOffsetY)
+{
+  if (!arc) return;
+
+  const Vector2 offset = { 0.0f, -screenOffsetY };
+  for (int i = 1; i < arc->pointCount; i++) {
+    // Every other segment, for a dotted line
+    if (i % 2 == 0) continue;
+    const Vector2 start = worldToScreen(Vector2Add(arc->points[i - 1], offset));
+    const Vector2 end = worldToScreen(Vector2Add(arc->points[i], offset));
+    DrawLineV(start, end, Fade(WHITE, 0.6f));
+  }
+  for (int i = 0; i < arc->bounceCount; i++) {
+    DrawCircleV(worldToScreen(Vector2Add(arc->bounces[i], offset)), 1.5f, YELLOW);
+  }
+  if (arc->isLanding) {
+    // Where the feet end up
+    const Vector2 landing = arc->points[arc->pointCount - 1];
+    const Vector2 feet = worldToScreen(Vector2Add(landing, (Vector2){ -PLAYER_SIZE.x, PLAYER_SIZE.y - screenOffsetY }));
+    DrawRectangleV(feet, (Vector2){ PLAYER_SIZE.x * 2.0f * TILE_PIXELS, 1.0f }, GREEN);
+  }
+}
@@ -0,0 +1,190 @@
+
+// Frame profiler: times the phases of the main loop, so a dropped frame can be blamed on one of them
+// without an external profiler.
+//
+// Every `beginProfilePhase`/`endProfilePhase` pair is one sample in a ring buffer (the last
+// `PROFILE_SAMPLE_COUNT` of them), and adds to its phase's time of the current frame. The graph
+// (toggled with 'G') stacks the phases of the last `PROFILE_FRAME_COUNT` frames, and 'T' writes
+// the samples in the ring buffer as Chrome trace events (open in chrome://tracing or Perfetto).
+
+#define PROFILE_SAMPLE_COUNT 4096
+#define PROFILE_FRAME_COUNT 240
+#define PROFILE_TRACE_FILE_NAME "profile-trace.json"
+#define PROFILE_GRAPH_PIXELS_Y 120
+#define PROFILE_GRAPH_MAX_SECONDS (1.0f / 20.0f) // Top of the graph
+#define PROFILE_LEGEND_REFRESH_INTERVAL 0.25f
+
+typedef enum {
+  PROFILE_UPDATE, // Input, level reload and physics steps
+  PROFILE_PIXELART, // Drawing the world into the pixel art texture
+  PROFILE_BLIT, // Scaling the pixel art texture to the window
+  PROFILE_DEBUG, // Debug overlay and this graph
+  PROFILE_PRESENT, // `EndDrawing`: swapping buffers, waiting for vsync
+  PROFILE_PHASE_COUNT,
+  PROFILE_FRAME = PROFILE_PHASE_COUNT, // A whole frame, only in the samples
+} ProfilePhase;
+
+const char* PROFILE_PHASE_NAMES[PROFILE_PHASE_COUNT + 1] = { "update", "pixelart", "blit", "debug", "present", "frame" };
+
+typedef struct {
+  double start; // `GetTime` seconds
+  float duration;
+  uint8_t phase; // `ProfilePhase`
+} ProfileSample;
+
+typedef struct {
+  ProfileSample samples[PROFILE_SAMPLE_COUNT];
+  uint64_t sampleCount; // All samples ever, the ring buffer holds the last ones
+
+  float frames[PROFILE_FRAME_COUNT][PROFILE_PHASE_COUNT]; // Seconds per phase
+  float frameTimes[PROFILE_FRAME_COUNT]; // Seconds of the whole frame
+  uint64_t frameCount;
+  double frameStart;
+
+  double phaseStarts[PROFILE_PHASE_COUNT];
+
+  // Average and max ms per phase over the graph, recomputed a few times per second
+  float legendAverage[PROFILE_PHASE_COUNT + 1];
+  float legendMax[PROFILE_PHASE_COUNT + 1];
+  float legendAge;
+} Profiler;
+
+Profiler profiler = { 0 };
+
+const Color PROFILE_PHASE_COLORS[PROFILE_PHASE_COUNT] = {
+  { 102, 191, 255, 255 }, // update
+  { 255, 161, 0, 255 }, // pixelart
+  { 0, 158, 47, 255 }, // blit
+  { 230, 41, 55, 255 }, // debug
+  { 130, 130, 130, 255 }, // present
+};
+
+void
+addProfileSample(ProfilePhase phase, double start, double end)
+{
+  ProfileSample* sample = &profiler.samples[profiler.sampleCount % PROFILE_SAMPLE_COUNT];
+  sample->start = start;
+  sample->duration = (float)(end - start);
+  sample->phase = (uint8_t)phase;
+  profiler.sampleCount++;
+}
+
+// Call first thing in the frame, closes the previous one
+void
+beginProfileFrame(void)
+{
+  const double now = GetTime();
+  if (profiler.frameStart > 0.0) {
+    addProfileSample(PROFILE_FRAME, profiler.frameStart, now);
+    profiler.frameTimes[profiler.frameCount % PROFILE_FRAME_COUNT] = (float)(now - profiler.frameStart);
+    profiler.frameCount++;
+  }
+  profiler.frameStart = now;
+
+  float* frame = profiler.frames[profiler.frameCount % PROFILE_FRAME_COUNT];
+  for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+    frame[i] = 0.0f;
+  }
+}
+
+void
+beginProfilePhase(ProfilePhase phase)
+{
+  profiler.phaseStarts[phase] = GetTime();
+}
+
+// A phase can run more than once per frame, its times add up
+void
+endProfilePhase(ProfilePhase phase)
+{
+  const double end = GetTime();
+  addProfileSample(phase, profiler.phaseStarts[phase], end);
+  profiler.frames[profiler.frameCount % PROFILE_FRAME_COUNT][phase] += (float)(end - profiler.phaseStarts[phase]);
+}
+
+// Writes the samples in the ring buffer as Chrome trace events. Returns false when the file can't be written.
+bool
+writeProfileTrace(const char* fileName)
+{
+  FILE* file = fopen(fileName, "w");
+  if (!file) return false;
+
+  const uint64_t first = profiler.sampleCount > PROFILE_SAMPLE_COUNT ? profiler.sampleCount - PROFILE_SAMPLE_COUNT : 0;
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (uint64_t i = first; i < profiler.sampleCount; i++) {
+    const ProfileSample* sample = &profiler.samples[i % PROFILE_SAMPLE_COUNT];
+    // Microseconds, phases nest inside their frame because they are on the same thread
+    fprintf(file, "{\"name\":\"%s\",\"cat\":\"jump-ray\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            PROFILE_PHASE_NAMES[sample->phase], sample->start * 1e6, (double)sample->duration * 1e6,
+            i + 1 < profiler.sampleCount ? "," : "");
+  }
+  fprintf(file, "]}\n");
+
+  const bool isWritten = !ferror(file);
+  fclose(file);
+  return isWritten;
+}
+
+void
+updateProfileLegend(float delta)
+{
+  profiler.legendAge += delta;
+  if (profiler.legendAge < PROFILE_LEGEND_REFRESH_INTERVAL) return;
+  profiler.legendAge = 0.0f;
+
+  const int frameCount = (int)fminf((float)profiler.frameCount, (float)PROFILE_FRAME_COUNT);
+  for (int phase = 0; phase <= PROFILE_PHASE_COUNT; phase++) {
+    float sum = 0.0f;
+    float max = 0.0f;
+    for (int i = 0; i < frameCount; i++) {
+      // Only finished frames
+      const uint64_t frame = profiler.frameCount - 1 - (uint64_t)i;
+      const float seconds = phase == PROFILE_FRAME ? profiler.frameTimes[frame % PROFILE_FRAME_COUNT]
+                                                   : profiler.frames[frame % PROFILE_FRAME_COUNT][phase];
+      sum += seconds;
+      max = fmaxf(max, seconds);
+    }
+    profiler.legendAverage[phase] = frameCount ? sum * 1000.0f / (float)frameCount : 0.0f;
+    profiler.legendMax[phase] = max * 1000.0f;
+  }
+}
+
+// Stacked bars of the phase times of the last frames, newest on the right, bottom left corner at `position`
+void
+drawProfileGraph(const Vector2 position, float delta)
+{
+  updateProfileLegend(delta);
+
+  const float pixelsPerSecond = PROFILE_GRAPH_PIXELS_Y / PROFILE_GRAPH_MAX_SECONDS;
+  DrawRectangle((int)position.x, (int)position.y - PROFILE_GRAPH_PIXELS_Y, PROFILE_FRAME_COUNT * 2, PROFILE_GRAPH_PIXELS_Y,
+                Fade(BLACK, 0.6f));
+
+  const int frameCount = (int)fminf((float)profiler.frameCount, (float)PROFILE_FRAME_COUNT);
+  for (int i = 0; i < frameCount; i++) {
+    const uint64_t frame = profiler.frameCount - (uint64_t)frameCount + (uint64_t)i;
+    const float* phases = profiler.frames[frame % PROFILE_FRAME_COUNT];
+    const int x = (int)position.x + (PROFILE_FRAME_COUNT - frameCount + i) * 2;
+    float y = position.y;
+    for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+      const float height = fminf(phases[phase] * pixelsPerSecond, y - (position.y - PROFILE_GRAPH_PIXELS_Y));
+      y -= height;
+      if (height >= 0.5f) DrawRectangle(x, (int)y, 2, (int)ceilf(height), PROFILE_PHASE_COLORS[phase]);
+    }
+    // What the phases don't cover: event polling, the profiler itself...
+    const float frameTop = position.y - fminf(profiler.frameTimes[frame % PROFILE_FRAME_COUNT] * pixelsPerSecond, PROFILE_GRAPH_PIXELS_Y);
+    DrawRectangle(x, (int)frameTop, 2, 1, WHITE);
+  }
+
+  // 60 and 30 frames per second
+  const int y60 = (int)(position.y - pixelsPerSecond / 60.0f);
+  const int y30 = (int)(position.y - pixelsPerSecond / 30.0f);
+  DrawLine((int)position.x, y60, (int)position.x + PROFILE_FRAME_COUNT * 2, y60, Fade(GREEN, 0.8f));
+  DrawLine((int)position.x, y30, (int)position.x + PROFILE_FRAME_COUNT * 2, y30, Fade(YELLOW, 0.8f));
+
+  for (int phase = 0; phase <= PROFILE_PHASE_COUNT; phase++) {
+    const Color color = phase < PROFILE_PHASE_COUNT ? PROFILE_PHASE_COLORS[phase] : WHITE;
+    DrawText(TextFormat("%-8s %5.2f avg %5.2f max ms", PROFILE_PHASE_NAMES[phase],
+                        profiler.legendAverage[phase], profiler.legendMax[phase]),
+             (int)position.x + PROFILE_FRAME_COUNT * 2 + 6, (int)position.y - PROFILE_GRAPH_PIXELS_Y + phase * 12, 10, color);
+  }
+}
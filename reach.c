@@ -0,0 +1,300 @@
+// Jump reachability: which platforms can be reached from which, found by simulating jumps.
+//
+// A jump is fully determined by where it starts, how many physics steps the jump key is held
+// (only `Clamp(jumpHoldTime * 2.6f, 1.1f, 2.0f)` matters, so just a few dozen step counts differ)
+// and the direction held when it's released. Walking off a ledge is the other way to get anywhere.
+// Every one of those moves is simulated with `stepPlayer` from a few spots on every platform,
+// and the platform it lands on becomes an edge of the graph.
+//
+// Moves from different screens don't depend on each other, so screens are simulated in parallel
+// (one thread per CPU, each takes the next screen). Needs `getCpuCount` from runner.c.
+
+// Longest fall/jump that's followed, in physics steps
+#define REACH_MAX_STEPS (PHYSICS_TICK_RATE * 4)
+// How far the player can stand past the end of a platform (ground probe half-width)
+#define REACH_LEDGE_OVERHANG 0.05f
+
+// Row of standable tiles: solid, with an empty tile above. World coordinates.
+// The top row of the level doesn't count, the player can't get above the level.
+typedef struct {
+    int screen; // Index into `mainTilemap`, 0 is the top screen
+    int y;
+    int startX;
+    int endX; // Inclusive
+} ReachPlatform;
+
+// Move that got from one platform to another (the first one found)
+typedef struct {
+    int from;
+    int to;
+    float startX;
+    int holdSteps; // 0 for walking off the ledge
+    int direction; // -1 left, 0 up, 1 right
+} ReachEdge;
+
+typedef struct {
+    ReachEdge* edges;
+    size_t count;
+    size_t capacity;
+} ReachEdgeList;
+
+typedef struct {
+    WorldSolids world;
+    int screenCount;
+
+    ReachPlatform* platforms;
+    int platformCount;
+    int* screenFirstPlatform; // Platforms of screen `i` are [screenFirstPlatform[i], screenFirstPlatform[i + 1])
+    int* tilePlatform; // Platform of each standable tile (rowCount * TILEMAP_SIZE_X), -1 for none
+
+    ReachEdgeList* screenEdges; // Edges starting on each screen, filled by the workers
+    int nextScreen; // Next screen for a worker to take
+} ReachGraph;
+
+void*
+allocateReachArray(size_t count, size_t itemSize)
+{
+    void* array = calloc(count ? count : 1, itemSize);
+    if (!array) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+// Platform under a tile, -1 when the tile isn't the top of a platform
+int
+getReachPlatform(const ReachGraph* graph, int x, int y)
+{
+    const int row = y - graph->world.topY;
+    if (x < 0 || x >= TILEMAP_SIZE_X || row < 0 || row >= graph->world.rowCount) return -1;
+    return graph->tilePlatform[row * TILEMAP_SIZE_X + x];
+}
+
+// Platform the player stands on (the ground probe may only touch a neighbor tile)
+int
+findReachLandingPlatform(const ReachGraph* graph, Vector2 position)
+{
+    const int y = (int)floorf(position.y + PLAYER_SIZE.y + PLAYER_GROUND_PROBE_SIZE.y);
+    int platform = getReachPlatform(graph, (int)floorf(position.x), y);
+    if (platform < 0) platform = getReachPlatform(graph, (int)floorf(position.x - PLAYER_GROUND_PROBE_SIZE.x), y);
+    if (platform < 0) platform = getReachPlatform(graph, (int)floorf(position.x + PLAYER_GROUND_PROBE_SIZE.x), y);
+    return platform;
+}
+
+// Finds the platforms of `graph->world`. The arrays are only allocated when they're NULL, so a graph
+// can be filled again for a world of the same size (level-gen checks every screen that way).
+void
+findReachPlatforms(ReachGraph* graph)
+{
+    const WorldSolids* world = &graph->world;
+    if (!graph->tilePlatform) {
+        graph->tilePlatform = (int*)allocateReachArray((size_t)world->rowCount * TILEMAP_SIZE_X, sizeof(int));
+        graph->screenFirstPlatform = (int*)allocateReachArray((size_t)graph->screenCount + 1, sizeof(int));
+        // At most one platform for every other tile in a row
+        const size_t maxPlatforms = (size_t)world->rowCount * (TILEMAP_SIZE_X + 1) / 2;
+        graph->platforms = (ReachPlatform*)allocateReachArray(maxPlatforms, sizeof(ReachPlatform));
+    }
+    graph->platformCount = 0;
+
+    for (int row = 0; row < world->rowCount; row++) {
+        const int y = world->topY + row;
+        const int screen = row / TILEMAP_SIZE_Y;
+        if (row % TILEMAP_SIZE_Y == 0) graph->screenFirstPlatform[screen] = graph->platformCount;
+
+        int* tiles = &graph->tilePlatform[row * TILEMAP_SIZE_X];
+        for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+            tiles[x] = -1;
+            const bool isStandable = row > 0 && worldSolidsIsTileFull(world, x, y) && !worldSolidsIsTileFull(world, x, y - 1);
+            if (!isStandable) continue;
+
+            ReachPlatform* last = graph->platformCount > 0 ? &graph->platforms[graph->platformCount - 1] : NULL;
+            if (last && last->y == y && last->endX == x - 1) {
+                last->endX = x;
+            } else {
+                graph->platforms[graph->platformCount++] = (ReachPlatform){ screen, y, x, x };
+            }
+            tiles[x] = graph->platformCount - 1;
+        }
+    }
+    graph->screenFirstPlatform[graph->screenCount] = graph->platformCount;
+}
+
+// Puts the player on a platform and lets it settle. Returns false if it doesn't stay there.
+bool
+placeReachPlayer(const ReachGraph* graph, int platform, float x, Player* outPlayer)
+{
+    Player sim = player;
+    sim.position = (Vector2){ x, (float)graph->platforms[platform].y - PLAYER_SIZE.y };
+    const PlayerInput noInput = { 0 };
+    for (int i = 0; i < 2; i++) {
+        sim = stepPlayer(sim, &graph->world, &noInput, PHYSICS_DELTA).player;
+    }
+    *outPlayer = sim;
+    return sim.isOnGround && findReachLandingPlatform(graph, sim.position) == platform;
+}
+
+// Follows a move until the player lands. Returns the platform, or -1 if it never lands on one.
+// `holdSteps` 0 walks off the ledge in `direction` instead of jumping.
+int
+simulateReachMove(const ReachGraph* graph, Player sim, int holdSteps, int direction)
+{
+    PlayerInput input = { 0 };
+    bool hasLeftGround = false;
+    const float maxY = (float)(graph->world.topY + graph->world.rowCount) + 1.0f;
+
+    for (int step = 0; step < REACH_MAX_STEPS + holdSteps; step++) {
+        input = (PlayerInput){ 0 };
+        if (holdSteps == 0) {
+            // Walk until falling
+            input.isRightDown = direction > 0 && !hasLeftGround;
+            input.isLeftDown = direction < 0 && !hasLeftGround;
+        } else if (step < holdSteps) {
+            input.isJumpDown = true;
+        } else if (step == holdSteps) {
+            input.isJumpReleased = true;
+            input.isRightDown = direction > 0;
+            input.isLeftDown = direction < 0;
+        }
+
+        const PlayerStepResult result = stepPlayer(sim, &graph->world, &input, PHYSICS_DELTA);
+        sim = result.player;
+
+        if (!sim.isOnGround) hasLeftGround = true;
+        if (hasLeftGround && (result.events & PLAYER_EVENT_LAND)) {
+            return findReachLandingPlatform(graph, sim.position);
+        }
+        // Walked into a wall without ever falling
+        if (holdSteps == 0 && step > PHYSICS_TICK_RATE && !hasLeftGround) return -1;
+        if (sim.position.y > maxY) return -1;
+    }
+    return -1;
+}
+
+void
+addReachEdge(ReachEdgeList* list, ReachEdge edge)
+{
+    // Only the first move between two platforms is kept
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->edges[i].from == edge.from && list->edges[i].to == edge.to) return;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->edges = (ReachEdge*)realloc(list->edges, list->capacity * sizeof(ReachEdge));
+        if (!list->edges) {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->edges[list->count++] = edge;
+}
+
+// Every move from every start spot of one platform
+void
+simulateReachPlatform(const ReachGraph* graph, int platform, ReachEdgeList* outEdges)
+{
+    const ReachPlatform* p = &graph->platforms[platform];
+
+    // Tile centers and edges, and the very ends of the platform
+    const int spotCount = (p->endX - p->startX + 1) * 2 + 1;
+    for (int spot = 0; spot < spotCount; spot++) {
+        float x = (float)p->startX + 0.5f * (float)spot;
+        if (spot == 0) x -= REACH_LEDGE_OVERHANG;
+        if (spot == spotCount - 1) x += REACH_LEDGE_OVERHANG;
+
+        Player start;
+        if (!placeReachPlayer(graph, platform, x, &start)) continue;
+
+        for (int direction = -1; direction <= 1; direction++) {
+            for (int hold = PLAYER_JUMP_MIN_HOLD_STEPS; hold <= PLAYER_JUMP_MAX_HOLD_STEPS; hold++) {
+                const int to = simulateReachMove(graph, start, hold, direction);
+                if (to >= 0) addReachEdge(outEdges, (ReachEdge){ platform, to, x, hold, direction });
+            }
+            // Walking off the ends
+            if (direction != 0 && (spot == 0 || spot == spotCount - 1)) {
+                const int to = simulateReachMove(graph, start, 0, direction);
+                if (to >= 0) addReachEdge(outEdges, (ReachEdge){ platform, to, x, 0, direction });
+            }
+        }
+    }
+}
+
+void*
+runReachWorker(void* data)
+{
+    ReachGraph* graph = (ReachGraph*)data;
+    for (;;) {
+        const int screen = __atomic_fetch_add(&graph->nextScreen, 1, __ATOMIC_RELAXED);
+        if (screen >= graph->screenCount) return NULL;
+
+        for (int platform = graph->screenFirstPlatform[screen]; platform < graph->screenFirstPlatform[screen + 1]; platform++) {
+            simulateReachPlatform(graph, platform, &graph->screenEdges[screen]);
+        }
+    }
+}
+
+// Builds the graph of a level. `threadCount` 0 uses one thread per CPU.
+void
+buildReachGraph(ReachGraph* graph, const WorldSolids* world, int threadCount)
+{
+    memset(graph, 0, sizeof(*graph));
+    graph->world = *world;
+    graph->screenCount = world->rowCount / TILEMAP_SIZE_Y;
+    findReachPlatforms(graph);
+    graph->screenEdges = (ReachEdgeList*)allocateReachArray((size_t)graph->screenCount, sizeof(ReachEdgeList));
+
+    if (threadCount <= 0) threadCount = getCpuCount();
+    if (threadCount > graph->screenCount) threadCount = graph->screenCount;
+    if (threadCount > SIM_MAX_THREADS) threadCount = SIM_MAX_THREADS;
+
+    pthread_t threads[SIM_MAX_THREADS];
+    for (int i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[i], NULL, runReachWorker, graph) != 0) {
+            fprintf(stderr, "Failed to start reachability thread!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    runReachWorker(graph);
+    for (int i = 1; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void
+freeReachGraph(ReachGraph* graph)
+{
+    for (int i = 0; i < graph->screenCount; i++) {
+        free(graph->screenEdges[i].edges);
+    }
+    free(graph->screenEdges);
+    free(graph->platforms);
+    free(graph->screenFirstPlatform);
+    free(graph->tilePlatform);
+    memset(graph, 0, sizeof(*graph));
+}
+
+// Marks every platform reachable from `start` (breadth-first). `outIsReachable` has one entry per platform.
+void
+findReachablePlatforms(const ReachGraph* graph, int start, bool* outIsReachable)
+{
+    memset(outIsReachable, 0, (size_t)graph->platformCount * sizeof(bool));
+    if (start < 0) return;
+
+    int* queue = (int*)allocateReachArray((size_t)graph->platformCount, sizeof(int));
+    int queueStart = 0;
+    int queueEnd = 0;
+    queue[queueEnd++] = start;
+    outIsReachable[start] = true;
+
+    while (queueStart < queueEnd) {
+        const int platform = queue[queueStart++];
+        const ReachEdgeList* edges = &graph->screenEdges[graph->platforms[platform].screen];
+        for (size_t i = 0; i < edges->count; i++) {
+            const ReachEdge* edge = &edges->edges[i];
+            if (edge->from != platform || outIsReachable[edge->to]) continue;
+            outIsReachable[edge->to] = true;
+            queue[queueEnd++] = edge->to;
+        }
+    }
+    free(queue);
+}
@@ -0,0 +1,408 @@
+// Input recording (*.jri): the input of every physics step of a session, so it can be replayed
+// exactly, e.g. to reproduce a bug or as a benchmark made of real play.
+//
+// Layout (native byte order):
+//   InputRecordingHeader
+//   entries, each:
+//     uint8_t  flags         INPUT_ENTRY_* bits
+//     float    stickX        only with INPUT_ENTRY_STICK, when it differs from the previous entry
+//     player                only with INPUT_ENTRY_PLAYER, the player was set before the step (a rewind,
+//                           the debug keys): float position[2], velocity[2], jumpHoldTime, animTime,
+//                           uint8_t INPUT_PLAYER_* bits. Version 1 recordings only have the position.
+//     varint   repeat        how many more steps used the same input (7 bits per byte, low first)
+//
+// Input changes a few times per second, so a session takes a few bytes per second.
+//
+// Recording never waits for the disk: entries go to a memory chunk, full chunks are handed
+// to a writer thread, and only that thread calls fwrite.
+
+#include <pthread.h>
+
+#define INPUT_RECORDING_MAGIC "JRIR"
+#define INPUT_RECORDING_VERSION 2
+#define INPUT_RECORDING_CHUNK_SIZE (64 * 1024)
+// Chunks are handed to the writer at least this often, so a crash loses little
+#define INPUT_RECORDING_FLUSH_STEPS (PHYSICS_TICK_RATE * 5)
+
+#define INPUT_ENTRY_JUMP_DOWN (1 << 0)
+#define INPUT_ENTRY_JUMP_RELEASED (1 << 1)
+#define INPUT_ENTRY_RIGHT_DOWN (1 << 2)
+#define INPUT_ENTRY_LEFT_DOWN (1 << 3)
+#define INPUT_ENTRY_MOVE_PRESSED (1 << 4)
+#define INPUT_ENTRY_GAMEPAD (1 << 5)
+#define INPUT_ENTRY_STICK (1 << 6)
+#define INPUT_ENTRY_PLAYER (1 << 7)
+
+#define INPUT_PLAYER_ON_GROUND (1 << 0)
+#define INPUT_PLAYER_FACING_RIGHT (1 << 1)
+// Position, velocity, jump hold and animation time, then the INPUT_PLAYER_* bits
+#define INPUT_PLAYER_FLOATS 6
+#define INPUT_PLAYER_SIZE (INPUT_PLAYER_FLOATS * sizeof(float) + 1)
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t tickRate; // `PHYSICS_TICK_RATE` of the recording
+    uint32_t screenCount;
+    uint32_t levelHash; // `hashWorldSolids` of the level it was recorded on
+    float startX;
+    float startY;
+    uint32_t reserved;
+} InputRecordingHeader;
+
+typedef struct InputChunk {
+    struct InputChunk* next;
+    size_t size;
+    uint8_t data[INPUT_RECORDING_CHUNK_SIZE];
+} InputChunk;
+
+typedef struct {
+    FILE* file;
+    InputChunk* chunk; // Being filled by the game
+
+    // Entry not written yet, it's extended while the input stays the same
+    bool hasEntry;
+    uint8_t entryFlags;
+    float entryStickX;
+    Player entryPlayer;
+    uint32_t entryRepeat;
+    float lastStickX;
+    uint64_t stepCount;
+
+    // Full chunks waiting for the writer thread
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    InputChunk* queueFirst;
+    InputChunk* queueLast;
+    bool isClosing;
+} InputRecorder;
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t offset;
+    InputRecordingHeader header;
+
+    // Current entry
+    PlayerInput input;
+    uint32_t repeatLeft;
+    float stickX;
+} InputReplay;
+
+// FNV-1a hash of a level's collision layer, to tell if a recording belongs to it
+uint32_t
+hashWorldSolids(const WorldSolids* world)
+{
+    uint32_t hash = 2166136261u;
+    for (int y = 0; y < world->rowCount; y++) {
+        hash = (hash ^ (world->rows[y] & 0xff)) * 16777619u;
+        hash = (hash ^ (world->rows[y] >> 8)) * 16777619u;
+    }
+    return hash;
+}
+
+InputChunk*
+allocateInputChunk(void)
+{
+    InputChunk* chunk = (InputChunk*)malloc(sizeof(InputChunk));
+    if (!chunk) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    chunk->next = NULL;
+    chunk->size = 0;
+    return chunk;
+}
+
+void*
+runInputRecorderWriter(void* data)
+{
+    InputRecorder* recorder = (InputRecorder*)data;
+
+    pthread_mutex_lock(&recorder->mutex);
+    for (;;) {
+        while (!recorder->queueFirst && !recorder->isClosing) {
+            pthread_cond_wait(&recorder->condition, &recorder->mutex);
+        }
+        InputChunk* chunks = recorder->queueFirst;
+        recorder->queueFirst = NULL;
+        recorder->queueLast = NULL;
+        const bool isClosing = recorder->isClosing;
+        pthread_mutex_unlock(&recorder->mutex);
+
+        while (chunks) {
+            InputChunk* next = chunks->next;
+            fwrite(chunks->data, 1, chunks->size, recorder->file);
+            free(chunks);
+            chunks = next;
+        }
+        fflush(recorder->file);
+
+        if (isClosing) return NULL;
+        pthread_mutex_lock(&recorder->mutex);
+    }
+}
+
+// Hands the current chunk to the writer thread and starts a new one
+void
+flushInputChunk(InputRecorder* recorder)
+{
+    InputChunk* chunk = recorder->chunk;
+    recorder->chunk = allocateInputChunk();
+
+    pthread_mutex_lock(&recorder->mutex);
+    if (recorder->queueLast) {
+        recorder->queueLast->next = chunk;
+    } else {
+        recorder->queueFirst = chunk;
+    }
+    recorder->queueLast = chunk;
+    pthread_cond_signal(&recorder->condition);
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+void
+appendInputBytes(InputRecorder* recorder, const void* bytes, size_t size)
+{
+    if (recorder->chunk->size + size > INPUT_RECORDING_CHUNK_SIZE) flushInputChunk(recorder);
+    memcpy(recorder->chunk->data + recorder->chunk->size, bytes, size);
+    recorder->chunk->size += size;
+}
+
+void
+appendPendingInputEntry(InputRecorder* recorder)
+{
+    if (!recorder->hasEntry) return;
+
+    // Largest entry: flags, stick, player and a 5 byte varint
+    uint8_t entry[1 + 4 + INPUT_PLAYER_SIZE + 5];
+    size_t size = 0;
+    entry[size++] = recorder->entryFlags;
+    if (recorder->entryFlags & INPUT_ENTRY_STICK) {
+        memcpy(entry + size, &recorder->entryStickX, sizeof(float));
+        size += sizeof(float);
+    }
+    if (recorder->entryFlags & INPUT_ENTRY_PLAYER) {
+        const Player* player = &recorder->entryPlayer;
+        const float floats[INPUT_PLAYER_FLOATS] = {
+            player->position.x, player->position.y, player->velocity.x, player->velocity.y,
+            player->jumpHoldTime, player->animTime,
+        };
+        memcpy(entry + size, floats, sizeof(floats));
+        size += sizeof(floats);
+        entry[size++] = (uint8_t)((player->isOnGround ? INPUT_PLAYER_ON_GROUND : 0) |
+                                  (player->isFacingRight ? INPUT_PLAYER_FACING_RIGHT : 0));
+    }
+    uint32_t repeat = recorder->entryRepeat;
+    do {
+        entry[size++] = (uint8_t)((repeat & 0x7f) | (repeat > 0x7f ? 0x80 : 0));
+        repeat >>= 7;
+    } while (repeat);
+
+    appendInputBytes(recorder, entry, size);
+    recorder->hasEntry = false;
+}
+
+bool
+startInputRecording(InputRecorder* recorder, const char* fileName, const WorldSolids* world, Vector2 startPosition)
+{
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->file = fopen(fileName, "wb");
+    if (!recorder->file) {
+        fprintf(stderr, "%s: can't open for writing\n", fileName);
+        return false;
+    }
+
+    InputRecordingHeader header = { 0 };
+    memcpy(header.magic, INPUT_RECORDING_MAGIC, sizeof(header.magic));
+    header.version = INPUT_RECORDING_VERSION;
+    header.tickRate = PHYSICS_TICK_RATE;
+    header.screenCount = (uint32_t)(world->rowCount / TILEMAP_SIZE_Y);
+    header.levelHash = hashWorldSolids(world);
+    header.startX = startPosition.x;
+    header.startY = startPosition.y;
+
+    recorder->chunk = allocateInputChunk();
+    appendInputBytes(recorder, &header, sizeof(header));
+
+    pthread_mutex_init(&recorder->mutex, NULL);
+    pthread_cond_init(&recorder->condition, NULL);
+    if (pthread_create(&recorder->thread, NULL, runInputRecorderWriter, recorder) != 0) {
+        fprintf(stderr, "Failed to start input recording thread!\n");
+        exit(EXIT_FAILURE);
+    }
+    return true;
+}
+
+// Records the input of one physics step. `setPlayer` is the player as it was set right before
+// the step (a rewind, the debug keys...), NULL when it wasn't.
+void
+recordPlayerInput(InputRecorder* recorder, const PlayerInput* input, const Player* setPlayer)
+{
+    if (!recorder->file) return;
+
+    uint8_t flags = 0;
+    if (input->isJumpDown) flags |= INPUT_ENTRY_JUMP_DOWN;
+    if (input->isJumpReleased) flags |= INPUT_ENTRY_JUMP_RELEASED;
+    if (input->isRightDown) flags |= INPUT_ENTRY_RIGHT_DOWN;
+    if (input->isLeftDown) flags |= INPUT_ENTRY_LEFT_DOWN;
+    if (input->isMovePressed) flags |= INPUT_ENTRY_MOVE_PRESSED;
+    if (input->isGamepad) flags |= INPUT_ENTRY_GAMEPAD;
+    // Compare bits, so -0.0 and NaN are replayed exactly too
+    if (memcmp(&input->stickX, &recorder->lastStickX, sizeof(float)) != 0) flags |= INPUT_ENTRY_STICK;
+    if (setPlayer) flags |= INPUT_ENTRY_PLAYER;
+
+    recorder->stepCount++;
+    if (recorder->stepCount % INPUT_RECORDING_FLUSH_STEPS == 0 && recorder->chunk->size > 0) {
+        flushInputChunk(recorder);
+    }
+
+    if (recorder->hasEntry && !setPlayer && flags == (recorder->entryFlags & ~INPUT_ENTRY_STICK) &&
+        recorder->entryRepeat < UINT32_MAX) {
+        recorder->entryRepeat++;
+        return;
+    }
+
+    appendPendingInputEntry(recorder);
+    recorder->hasEntry = true;
+    recorder->entryFlags = flags;
+    recorder->entryStickX = input->stickX;
+    recorder->entryRepeat = 0;
+    if (setPlayer) recorder->entryPlayer = *setPlayer;
+    recorder->lastStickX = input->stickX;
+}
+
+// Writes what's left and waits for the writer thread
+void
+stopInputRecording(InputRecorder* recorder)
+{
+    if (!recorder->file) return;
+
+    appendPendingInputEntry(recorder);
+    flushInputChunk(recorder);
+    free(recorder->chunk);
+
+    pthread_mutex_lock(&recorder->mutex);
+    recorder->isClosing = true;
+    pthread_cond_signal(&recorder->condition);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->thread, NULL);
+
+    pthread_mutex_destroy(&recorder->mutex);
+    pthread_cond_destroy(&recorder->condition);
+    fclose(recorder->file);
+    memset(recorder, 0, sizeof(*recorder));
+}
+
+void
+closeInputReplay(InputReplay* replay)
+{
+    free(replay->data);
+    memset(replay, 0, sizeof(*replay));
+}
+
+bool
+openInputReplay(InputReplay* replay, const char* fileName)
+{
+    memset(replay, 0, sizeof(*replay));
+
+    FILE* file = fopen(fileName, "rb");
+    if (!file) {
+        fprintf(stderr, "%s: can't open\n", fileName);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < (long)sizeof(InputRecordingHeader)) {
+        fprintf(stderr, "%s: not an input recording\n", fileName);
+        fclose(file);
+        return false;
+    }
+
+    replay->data = (uint8_t*)malloc((size_t)size);
+    if (!replay->data) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    replay->size = fread(replay->data, 1, (size_t)size, file);
+    fclose(file);
+
+    memcpy(&replay->header, replay->data, sizeof(replay->header));
+    if (replay->size != (size_t)size || memcmp(replay->header.magic, INPUT_RECORDING_MAGIC, 4) != 0 ||
+        replay->header.version < 1 || replay->header.version > INPUT_RECORDING_VERSION) {
+        fprintf(stderr, "%s: not an input recording, or a different version\n", fileName);
+        closeInputReplay(replay);
+        return false;
+    }
+    replay->offset = sizeof(InputRecordingHeader);
+    return true;
+}
+
+// Input of the next physics step. Returns false at the end of the recording.
+// When the player was set before the step, `player` is set the same way and `outIsPlayerSet` is true.
+bool
+nextReplayInput(InputReplay* replay, PlayerInput* outInput, Player* player, bool* outIsPlayerSet)
+{
+    *outIsPlayerSet = false;
+    if (replay->repeatLeft > 0) {
+        replay->repeatLeft--;
+        *outInput = replay->input;
+        return true;
+    }
+
+    const uint8_t* data = replay->data;
+    const size_t size = replay->size;
+    size_t offset = replay->offset;
+    if (offset >= size) return false;
+
+    const uint8_t flags = data[offset++];
+    if (flags & INPUT_ENTRY_STICK) {
+        if (offset + sizeof(float) > size) return false;
+        memcpy(&replay->stickX, data + offset, sizeof(float));
+        offset += sizeof(float);
+    }
+    if ((flags & INPUT_ENTRY_PLAYER) && replay->header.version == 1) {
+        if (offset + sizeof(Vector2) > size) return false;
+        memcpy(&player->position, data + offset, sizeof(Vector2));
+        offset += sizeof(Vector2);
+        *outIsPlayerSet = true;
+    } else if (flags & INPUT_ENTRY_PLAYER) {
+        if (offset + INPUT_PLAYER_SIZE > size) return false;
+        float floats[INPUT_PLAYER_FLOATS];
+        memcpy(floats, data + offset, sizeof(floats));
+        const uint8_t playerFlags = data[offset + sizeof(floats)];
+        offset += INPUT_PLAYER_SIZE;
+        player->position = (Vector2){ floats[0], floats[1] };
+        player->velocity = (Vector2){ floats[2], floats[3] };
+        player->jumpHoldTime = floats[4];
+        player->animTime = floats[5];
+        player->isOnGround = playerFlags & INPUT_PLAYER_ON_GROUND;
+        player->isFacingRight = playerFlags & INPUT_PLAYER_FACING_RIGHT;
+        *outIsPlayerSet = true;
+    }
+    uint32_t repeat = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (offset >= size || shift > 28) return false;
+        const uint8_t byte = data[offset++];
+        repeat |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    replay->offset = offset;
+
+    PlayerInput input = { 0 };
+    input.isJumpDown = flags & INPUT_ENTRY_JUMP_DOWN;
+    input.isJumpReleased = flags & INPUT_ENTRY_JUMP_RELEASED;
+    input.isRightDown = flags & INPUT_ENTRY_RIGHT_DOWN;
+    input.isLeftDown = flags & INPUT_ENTRY_LEFT_DOWN;
+    input.isMovePressed = flags & INPUT_ENTRY_MOVE_PRESSED;
+    input.isGamepad = flags & INPUT_ENTRY_GAMEPAD;
+    input.stickX = replay->stickX;
+
+    // Repeats never set the player again
+    replay->input = input;
+    replay->repeatLeft = repeat;
+    *outInput = input;
+    return true;
+}
@@ -0,0 +1,154 @@
+
+// Sprite of the player sheet for the player's state (standing, walking, charging a jump, in the air)
+int
+getPlayerSprite(const Player* player)
+{
+  if (!player->isOnGround) return player->velocity.y > 0 ? 5 : 6;
+  if (player->jumpHoldTime > 0.001) return 4;
+  if (fabsf(player->velocity.x) > 0.01) return 1 + ((int)floorf(player->animTime * 6.0f)) % 2;
+  return 0;
+}
+
+// Where the player's sprite is drawn in the pixel art view, `position` relative to the current screen
+Vector2
+getPlayerSpritePosition(Vector2 position)
+{
+  const Vector2 spriteOrigin = { 8, 10 };
+  return Vector2Subtract(worldToScreen(position), spriteOrigin);
+}
+
+// Draw all the tiles of a screen
+void
+drawTilemap(const TilemapSolids* solids)
+{
+  const WorldSolids screen = getScreenWorldSolids(solids);
+  for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
+    uint8_t masks[TILEMAP_SIZE_X];
+    autotileRowMasks(solids, y, masks);
+
+    for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+      if (!worldSolidsIsTileFull(&screen, x, y)) continue;
+      // DrawRectangle(x * TILE_PIXELS, y * TILE_PIXELS, TILE_PIXELS, TILE_PIXELS, ORANGE);
+
+      const AutotileSprite sprite = autotileTable[masks[x]];
+      Vector2 position = { (float)x * TILE_PIXELS, (float)y * TILE_PIXELS };
+      Vector2 scale = { 1, 1 };
+      drawAtlasSprite(SPRITE_SHEET_TILEMAP, sprite.x, sprite.y, position, scale);
+    }
+  }
+}
+
+
+// Screens never change while playing, so their tiles are drawn once into a render texture
+// ("layer") and then drawn with a single blit.
+// We keep the current screen and the ones right above and below it, so moving
+// between screens doesn't have to wait for the bake.
+#define TILEMAP_LAYER_COUNT 3
+#define TILEMAP_LAYER_NONE -1
+
+typedef struct {
+  RenderTexture texture;
+  int screenIndex; // `TILEMAP_LAYER_NONE` when the slot is free
+} TilemapLayer;
+
+TilemapLayer tilemapLayers[TILEMAP_LAYER_COUNT];
+
+void
+loadTilemapLayers(void)
+{
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    tilemapLayers[i].texture = LoadRenderTexture(VIEW_PIXELS_X, VIEW_PIXELS_Y);
+    tilemapLayers[i].screenIndex = TILEMAP_LAYER_NONE;
+  }
+}
+
+void
+unloadTilemapLayers(void)
+{
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    UnloadRenderTexture(tilemapLayers[i].texture);
+    tilemapLayers[i].screenIndex = TILEMAP_LAYER_NONE;
+  }
+}
+
+// Forget the baked tiles of a screen, so they're drawn again next time (e.g. when the screen was edited)
+void
+invalidateTilemapLayer(int screenIndex)
+{
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    if (tilemapLayers[i].screenIndex == screenIndex) tilemapLayers[i].screenIndex = TILEMAP_LAYER_NONE;
+  }
+}
+
+void
+invalidateTilemapLayers(void)
+{
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    tilemapLayers[i].screenIndex = TILEMAP_LAYER_NONE;
+  }
+}
+
+TilemapLayer*
+findTilemapLayer(int screenIndex)
+{
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    if (tilemapLayers[i].screenIndex == screenIndex) return &tilemapLayers[i];
+  }
+  return NULL;
+}
+
+// Bake the screen into a free slot, or the one farthest away from `currentScreenIndex`.
+// Note: must be called outside of `BeginTextureMode`/`EndTextureMode`.
+void
+bakeTilemapLayer(int screenIndex, int currentScreenIndex)
+{
+  TilemapLayer* layer = &tilemapLayers[0];
+  for (int i = 0; i < TILEMAP_LAYER_COUNT; i++) {
+    if (tilemapLayers[i].screenIndex == TILEMAP_LAYER_NONE) {
+      layer = &tilemapLayers[i];
+      break;
+    }
+    if (abs(tilemapLayers[i].screenIndex - currentScreenIndex) > abs(layer->screenIndex - currentScreenIndex)) {
+      layer = &tilemapLayers[i];
+    }
+  }
+
+  BeginTextureMode(layer->texture);
+  ClearBackground(BLANK);
+  drawTilemap(getScreenSolids(screenIndex));
+  EndTextureMode();
+
+  layer->screenIndex = screenIndex;
+}
+
+// Make sure the current screen is baked, and prefetch one neighbor screen per call.
+// Call once per frame, before drawing.
+void
+updateTilemapLayers(int screenIndex)
+{
+  if (!findTilemapLayer(screenIndex)) {
+    bakeTilemapLayer(screenIndex, screenIndex);
+  }
+
+  const int neighbors[] = { screenIndex - 1, screenIndex + 1 };
+  for (int i = 0; i < 2; i++) {
+    const int neighbor = neighbors[i];
+    if (neighbor < 0 || (size_t)neighbor >= numOfLevels) continue;
+    if (findTilemapLayer(neighbor)) continue;
+
+    bakeTilemapLayer(neighbor, screenIndex);
+    break;
+  }
+}
+
+// Draw the baked tiles of a screen at the origin of the current render target
+void
+drawTilemapLayer(int screenIndex)
+{
+  const TilemapLayer* layer = findTilemapLayer(screenIndex);
+  if (!layer) return;
+
+  // Render textures are upside down
+  Rectangle source = { 0, 0, (float)layer->texture.texture.width, -(float)layer->texture.texture.height };
+  DrawTextureRec(layer->texture.texture, source, Vector2Zero(), WHITE);
+}
@@ -0,0 +1,292 @@
+// Rewind buffer: the player of every physics step, so a mistake can be undone by scrubbing back.
+//
+// Snapshots are kept in segments of `REWIND_KEYFRAME_INTERVAL` steps. A segment starts with its
+// first player as it is (the keyframe), the others are stored as a delta against the keyframe:
+//     uint8_t  changed       bit `i` for field `i` (see `getRewindFields`), bit 7 for the flags
+//     varint   xor[]         for every changed field, its bits XOR the keyframe's (7 bits per byte, low first)
+//     uint8_t  flags         only when changed
+// Nearby floats share their high bits, so the XOR is small, and fields that didn't change
+// (standing still, the jump hold time in the air...) take no space at all.
+//
+// Segments are written one after the other into a fixed byte ring, the oldest are dropped when
+// it's full. Restoring a snapshot finds its segment directly and walks at most one segment's deltas.
+
+#define REWIND_KEYFRAME_INTERVAL PHYSICS_TICK_RATE
+#define REWIND_FIELD_COUNT 6
+#define REWIND_FLAGS_CHANGED (1 << 7)
+// Largest delta: the changed bits, a 5 byte varint per field and the flags
+#define REWIND_MAX_DELTA_BYTES (1 + REWIND_FIELD_COUNT * 5 + 1)
+#define REWIND_MAX_SEGMENT_BYTES (sizeof(Player) + (REWIND_KEYFRAME_INTERVAL - 1) * REWIND_MAX_DELTA_BYTES)
+// Smallest segment: the keyframe and a byte per delta
+#define REWIND_MIN_SEGMENT_BYTES (sizeof(Player) + (REWIND_KEYFRAME_INTERVAL - 1))
+
+typedef struct {
+    size_t offset; // In `RewindBuffer.bytes`, the keyframe then the deltas
+    size_t size;
+    uint32_t count; // Snapshots, with the keyframe
+} RewindSegment;
+
+typedef struct {
+    uint8_t* bytes;
+    size_t capacity;
+    size_t writeOffset; // End of the newest segment
+
+    // Ring of segments, segment `i` is `segments[i % segmentCapacity]`
+    RewindSegment* segments;
+    size_t segmentCapacity;
+    uint64_t firstSegment; // Oldest
+    uint64_t segmentEnd; // One past the newest
+
+    size_t snapshotCount;
+} RewindBuffer;
+
+void
+createRewindBuffer(RewindBuffer* buffer, size_t bytes)
+{
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->capacity = bytes > REWIND_MAX_SEGMENT_BYTES ? bytes : REWIND_MAX_SEGMENT_BYTES;
+    // Enough segments to fill the bytes even if every segment is as small as it gets
+    buffer->segmentCapacity = buffer->capacity / REWIND_MIN_SEGMENT_BYTES + 1;
+    buffer->bytes = (uint8_t*)malloc(buffer->capacity);
+    buffer->segments = (RewindSegment*)malloc(buffer->segmentCapacity * sizeof(RewindSegment));
+    if (!buffer->bytes || !buffer->segments) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void
+freeRewindBuffer(RewindBuffer* buffer)
+{
+    free(buffer->bytes);
+    free(buffer->segments);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+void
+clearRewindBuffer(RewindBuffer* buffer)
+{
+    buffer->writeOffset = 0;
+    buffer->firstSegment = 0;
+    buffer->segmentEnd = 0;
+    buffer->snapshotCount = 0;
+}
+
+RewindSegment*
+getRewindSegment(const RewindBuffer* buffer, uint64_t index)
+{
+    return &buffer->segments[index % buffer->segmentCapacity];
+}
+
+// The player as 32-bit fields and flags
+uint8_t
+getRewindFields(const Player* player, uint32_t outFields[REWIND_FIELD_COUNT])
+{
+    const float floats[REWIND_FIELD_COUNT] = {
+        player->position.x, player->position.y, player->velocity.x, player->velocity.y,
+        player->jumpHoldTime, player->animTime,
+    };
+    memcpy(outFields, floats, sizeof(floats));
+    return (uint8_t)((player->isOnGround ? 1 : 0) | (player->isFacingRight ? 2 : 0));
+}
+
+void
+setRewindFields(Player* player, const uint32_t fields[REWIND_FIELD_COUNT], uint8_t flags)
+{
+    float floats[REWIND_FIELD_COUNT];
+    memcpy(floats, fields, sizeof(floats));
+    player->position = (Vector2){ floats[0], floats[1] };
+    player->velocity = (Vector2){ floats[2], floats[3] };
+    player->jumpHoldTime = floats[4];
+    player->animTime = floats[5];
+    player->isOnGround = flags & 1;
+    player->isFacingRight = flags & 2;
+}
+
+// Writes the delta of `player` against `keyframe`, returns its size
+size_t
+encodeRewindDelta(uint8_t* out, const Player* keyframe, const Player* player)
+{
+    uint32_t keyFields[REWIND_FIELD_COUNT];
+    uint32_t fields[REWIND_FIELD_COUNT];
+    const uint8_t keyFlags = getRewindFields(keyframe, keyFields);
+    const uint8_t flags = getRewindFields(player, fields);
+
+    size_t size = 1;
+    uint8_t changed = 0;
+    for (int i = 0; i < REWIND_FIELD_COUNT; i++) {
+        uint32_t bits = fields[i] ^ keyFields[i];
+        if (!bits) continue;
+        changed |= (uint8_t)(1 << i);
+        do {
+            out[size++] = (uint8_t)((bits & 0x7f) | (bits > 0x7f ? 0x80 : 0));
+            bits >>= 7;
+        } while (bits);
+    }
+    if (flags != keyFlags) {
+        changed |= REWIND_FLAGS_CHANGED;
+        out[size++] = flags;
+    }
+    out[0] = changed;
+    return size;
+}
+
+// Reads a delta written by `encodeRewindDelta`, returns its size. `outPlayer` can be NULL to only skip it.
+size_t
+decodeRewindDelta(const uint8_t* in, const Player* keyframe, Player* outPlayer)
+{
+    uint32_t fields[REWIND_FIELD_COUNT];
+    uint8_t flags = getRewindFields(keyframe, fields);
+
+    const uint8_t changed = in[0];
+    size_t size = 1;
+    for (int i = 0; i < REWIND_FIELD_COUNT; i++) {
+        if (!(changed & (1 << i))) continue;
+        uint32_t bits = 0;
+        int shift = 0;
+        uint8_t byte = 0;
+        do {
+            byte = in[size++];
+            bits |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && shift < 35);
+        fields[i] ^= bits;
+    }
+    if (changed & REWIND_FLAGS_CHANGED) flags = in[size++];
+
+    if (outPlayer) setRewindFields(outPlayer, fields, flags);
+    return size;
+}
+
+// Whether the bytes in [begin, end) aren't used by any segment
+bool
+isRewindRangeFree(const RewindBuffer* buffer, size_t begin, size_t end)
+{
+    if (buffer->firstSegment == buffer->segmentEnd) return true;
+
+    // Segments are used from the oldest's start to the newest's end, around the ring
+    const size_t tail = getRewindSegment(buffer, buffer->firstSegment)->offset;
+    const size_t head = buffer->writeOffset;
+    if (tail < head) return tail >= end || begin >= head;
+    return tail >= end && begin >= head; // `tail == head` is full, segments are never empty
+}
+
+void
+dropOldestRewindSegment(RewindBuffer* buffer)
+{
+    buffer->snapshotCount -= getRewindSegment(buffer, buffer->firstSegment)->count;
+    buffer->firstSegment++;
+}
+
+void
+startRewindSegment(RewindBuffer* buffer, const Player* keyframe)
+{
+    if (buffer->segmentEnd - buffer->firstSegment == buffer->segmentCapacity) dropOldestRewindSegment(buffer);
+
+    // Room for a whole segment, so its deltas never wrap around the end of the ring
+    size_t offset = buffer->writeOffset;
+    if (offset + REWIND_MAX_SEGMENT_BYTES > buffer->capacity) offset = 0;
+    while (!isRewindRangeFree(buffer, offset, offset + REWIND_MAX_SEGMENT_BYTES)) {
+        dropOldestRewindSegment(buffer);
+    }
+    if (buffer->firstSegment == buffer->segmentEnd) offset = 0;
+
+    RewindSegment* segment = getRewindSegment(buffer, buffer->segmentEnd++);
+    segment->offset = offset;
+    segment->size = sizeof(Player);
+    segment->count = 1;
+    memcpy(buffer->bytes + offset, keyframe, sizeof(Player));
+    buffer->writeOffset = offset + segment->size;
+    buffer->snapshotCount++;
+}
+
+// Keep the player of a physics step
+void
+pushRewindSnapshot(RewindBuffer* buffer, const Player* player)
+{
+    RewindSegment* segment = buffer->segmentEnd > buffer->firstSegment ? getRewindSegment(buffer, buffer->segmentEnd - 1) : NULL;
+    if (!segment || segment->count >= REWIND_KEYFRAME_INTERVAL) {
+        startRewindSegment(buffer, player);
+        return;
+    }
+
+    Player keyframe;
+    memcpy(&keyframe, buffer->bytes + segment->offset, sizeof(Player));
+    segment->size += encodeRewindDelta(buffer->bytes + segment->offset + segment->size, &keyframe, player);
+    segment->count++;
+    buffer->writeOffset = segment->offset + segment->size;
+    buffer->snapshotCount++;
+}
+
+// Every segment but the newest is full, so the segment of a snapshot is found without a search
+uint64_t
+findRewindSegment(const RewindBuffer* buffer, size_t stepsBack, uint32_t* outIndex)
+{
+    const size_t index = buffer->snapshotCount - 1 - stepsBack; // From the oldest
+    *outIndex = (uint32_t)(index % REWIND_KEYFRAME_INTERVAL);
+    return buffer->firstSegment + index / REWIND_KEYFRAME_INTERVAL;
+}
+
+// The player `stepsBack` steps before the newest snapshot (0 is the newest).
+// Returns false when the buffer doesn't go back that far.
+bool
+getRewindSnapshot(const RewindBuffer* buffer, size_t stepsBack, Player* outPlayer)
+{
+    if (stepsBack >= buffer->snapshotCount) return false;
+
+    uint32_t index = 0;
+    const RewindSegment* segment = getRewindSegment(buffer, findRewindSegment(buffer, stepsBack, &index));
+    const uint8_t* bytes = buffer->bytes + segment->offset;
+
+    Player keyframe;
+    memcpy(&keyframe, bytes, sizeof(Player));
+    size_t offset = sizeof(Player);
+    for (uint32_t i = 1; i < index; i++) {
+        offset += decodeRewindDelta(bytes + offset, &keyframe, NULL);
+    }
+    if (index == 0) {
+        *outPlayer = keyframe;
+    } else {
+        decodeRewindDelta(bytes + offset, &keyframe, outPlayer);
+    }
+    return true;
+}
+
+// Forget the newest `steps` snapshots, e.g. to continue playing from a rewound one
+void
+dropNewestRewindSnapshots(RewindBuffer* buffer, size_t steps)
+{
+    if (steps >= buffer->snapshotCount) {
+        clearRewindBuffer(buffer);
+        return;
+    }
+    if (steps == 0) return;
+
+    uint32_t index = 0;
+    const uint64_t last = findRewindSegment(buffer, steps, &index); // Segment of the snapshot that stays newest
+    buffer->segmentEnd = last + 1;
+    buffer->snapshotCount -= steps;
+
+    RewindSegment* segment = getRewindSegment(buffer, last);
+    const uint8_t* bytes = buffer->bytes + segment->offset;
+    Player keyframe;
+    memcpy(&keyframe, bytes, sizeof(Player));
+    size_t size = sizeof(Player);
+    for (uint32_t i = 1; i <= index; i++) {
+        size += decodeRewindDelta(bytes + size, &keyframe, NULL);
+    }
+    segment->count = index + 1;
+    segment->size = size;
+    buffer->writeOffset = segment->offset + size;
+}
+
+// Bytes used by the segments, for the debug HUD
+size_t
+getRewindBufferUsedBytes(const RewindBuffer* buffer)
+{
+    size_t bytes = 0;
+    for (uint64_t i = buffer->firstSegment; i < buffer->segmentEnd; i++) {
+        bytes += getRewindSegment(buffer, i)->size;
+    }
+    return bytes;
+}
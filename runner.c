@@ -0,0 +1,226 @@
+// Runs many independent physics rollouts ("jobs") on all cores.
+//
+// A job is a start position, a sequence of inputs (one per physics step) and a level.
+// Jobs only read the level, and `stepPlayer` only touches the state it's given,
+// so workers share nothing but the job ranges below.
+//
+// Every worker owns a range of job indices. It takes jobs from the front of its range,
+// and when the range is empty it steals the back half of the fullest range of another worker.
+// A range is a single 64-bit word changed with compare-and-swap, so taking and stealing never block.
+// Each job writes its result to its own slot, so results are collected without locks too.
+
+#include <pthread.h>
+#include <sys/time.h> // gettimeofday
+#if !defined(_WIN32)
+#include <unistd.h> // sysconf
+#endif
+
+#define SIM_MAX_THREADS 64
+#define SIM_CACHE_LINE_SIZE 64
+
+// `_Alignas` is C11, the tools are built as C99
+#if defined(_MSC_VER)
+#define SIM_ALIGNED(bytes) __declspec(align(bytes))
+#else
+#define SIM_ALIGNED(bytes) __attribute__((aligned(bytes)))
+#endif
+
+typedef struct {
+    Vector2 startPosition;
+    const PlayerInput* inputs; // One per physics step
+    size_t inputCount;
+    const WorldSolids* world;
+} SimJob;
+
+typedef struct {
+    Player player; // State after the last step
+    float highestY; // Lowest position.y reached, up is negative
+    uint32_t jumps;
+    uint32_t landings;
+    uint32_t bumps;
+} SimResult;
+
+// Job range [begin, end) packed into one word, so it can be swapped atomically
+typedef uint64_t SimRange;
+
+#define SIM_RANGE(begin, end) (((uint64_t)(end) << 32) | (uint32_t)(begin))
+#define SIM_RANGE_BEGIN(range) ((uint32_t)(range))
+#define SIM_RANGE_END(range) ((uint32_t)((range) >> 32))
+
+typedef struct SimRunner SimRunner;
+
+typedef struct {
+    // Each worker on its own cache line, the range is hit by thieves
+    SIM_ALIGNED(SIM_CACHE_LINE_SIZE) SimRange range;
+    SimRunner* runner;
+    int index;
+    uint32_t jobsRun;
+    uint32_t steals;
+    pthread_t thread;
+} SimWorker;
+
+struct SimRunner {
+    const SimJob* jobs;
+    SimResult* results;
+    float delta;
+    int workerCount;
+    SimWorker workers[SIM_MAX_THREADS];
+};
+
+int
+getCpuCount(void)
+{
+#if defined(_WIN32)
+    const char* count = getenv("NUMBER_OF_PROCESSORS");
+    const int cpus = count ? atoi(count) : 1;
+#else
+    const int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (cpus < 1) return 1;
+    if (cpus > SIM_MAX_THREADS) return SIM_MAX_THREADS;
+    return cpus;
+}
+
+// Wall clock time, `clock()` adds up the time of all threads
+double
+getWallSeconds(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double)now.tv_sec + (double)now.tv_usec / 1e6;
+}
+
+SimResult
+runSimJob(const SimJob* job, float delta)
+{
+    SimResult result = { 0 };
+    Player sim = player;
+    sim.position = job->startPosition;
+    result.highestY = sim.position.y;
+
+    for (size_t i = 0; i < job->inputCount; i++) {
+        const PlayerStepResult step = stepPlayer(sim, job->world, &job->inputs[i], delta);
+        sim = step.player;
+
+        if (sim.position.y < result.highestY) result.highestY = sim.position.y;
+        if (step.events & PLAYER_EVENT_JUMP) result.jumps++;
+        if (step.events & PLAYER_EVENT_LAND) result.landings++;
+        if (step.events & PLAYER_EVENT_BUMP) result.bumps++;
+    }
+
+    result.player = sim;
+    return result;
+}
+
+// Takes the first job of the worker's own range. Returns false when the range is empty.
+bool
+takeSimJob(SimWorker* worker, uint32_t* outJob)
+{
+    SimRange range = __atomic_load_n(&worker->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        const uint32_t begin = SIM_RANGE_BEGIN(range);
+        const uint32_t end = SIM_RANGE_END(range);
+        if (begin >= end) return false;
+        // On failure `range` is reloaded, a thief took part of it
+        if (__atomic_compare_exchange_n(&worker->range, &range, SIM_RANGE(begin + 1, end), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *outJob = begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of the fullest other range into the worker's (empty) range.
+// Returns false when there's nothing left to steal anywhere.
+bool
+stealSimJobs(SimWorker* worker)
+{
+    SimRunner* runner = worker->runner;
+    for (;;) {
+        SimWorker* victim = NULL;
+        SimRange victimRange = 0;
+        uint32_t mostJobs = 0;
+        for (int i = 0; i < runner->workerCount; i++) {
+            if (i == worker->index) continue;
+            const SimRange range = __atomic_load_n(&runner->workers[i].range, __ATOMIC_ACQUIRE);
+            const uint32_t jobs = SIM_RANGE_END(range) - SIM_RANGE_BEGIN(range);
+            if (SIM_RANGE_BEGIN(range) < SIM_RANGE_END(range) && jobs > mostJobs) {
+                victim = &runner->workers[i];
+                victimRange = range;
+                mostJobs = jobs;
+            }
+        }
+        if (!victim) return false;
+
+        // With a single job left, steal it, the victim might be busy with a long one
+        const uint32_t begin = SIM_RANGE_BEGIN(victimRange);
+        const uint32_t end = SIM_RANGE_END(victimRange);
+        const uint32_t middle = begin + (end - begin) / 2;
+        if (__atomic_compare_exchange_n(&victim->range, &victimRange, SIM_RANGE(begin, middle), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            // Nobody steals from an empty range, so a plain store is enough
+            __atomic_store_n(&worker->range, SIM_RANGE(middle, end), __ATOMIC_RELEASE);
+            worker->steals++;
+            return true;
+        }
+        // Lost the race against the victim or another thief, look again
+    }
+}
+
+void*
+runSimWorker(void* data)
+{
+    SimWorker* worker = (SimWorker*)data;
+    SimRunner* runner = worker->runner;
+
+    do {
+        uint32_t job = 0;
+        while (takeSimJob(worker, &job)) {
+            runner->results[job] = runSimJob(&runner->jobs[job], runner->delta);
+            worker->jobsRun++;
+        }
+    } while (stealSimJobs(worker));
+
+    return NULL;
+}
+
+// Runs every job and writes its result to `results` (same index).
+// `threadCount` 0 uses one thread per CPU. Fills `runner` with per-worker stats.
+void
+runSimJobs(SimRunner* runner, const SimJob* jobs, size_t jobCount, SimResult* results, int threadCount, float delta)
+{
+    if (jobCount > UINT32_MAX) {
+        fprintf(stderr, "Too many simulation jobs: %zu\n", jobCount);
+        exit(EXIT_FAILURE);
+    }
+    if (threadCount <= 0) threadCount = getCpuCount();
+    if (threadCount > SIM_MAX_THREADS) threadCount = SIM_MAX_THREADS;
+
+    memset(runner, 0, sizeof(*runner));
+    runner->jobs = jobs;
+    runner->results = results;
+    runner->delta = delta;
+    runner->workerCount = threadCount;
+
+    // Start with an even split, stealing evens out jobs of different lengths
+    for (int i = 0; i < threadCount; i++) {
+        SimWorker* worker = &runner->workers[i];
+        worker->runner = runner;
+        worker->index = i;
+        const uint32_t begin = (uint32_t)(jobCount * (size_t)i / (size_t)threadCount);
+        const uint32_t end = (uint32_t)(jobCount * (size_t)(i + 1) / (size_t)threadCount);
+        worker->range = SIM_RANGE(begin, end);
+    }
+
+    // The calling thread is worker 0
+    for (int i = 1; i < threadCount; i++) {
+        if (pthread_create(&runner->workers[i].thread, NULL, runSimWorker, &runner->workers[i]) != 0) {
+            fprintf(stderr, "Failed to start simulation thread!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    runSimWorker(&runner->workers[0]);
+    for (int i = 1; i < threadCount; i++) {
+        pthread_join(runner->workers[i].thread, NULL);
+    }
+}
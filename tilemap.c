@@ -16,6 +16,15 @@ typedef enum { TILE_EMPTY = ' ', TILE_ZERO = '\0', TILE_FULL = '#' } Tile;
 // we're defining the tilemaps with strings.
 typedef uint8_t Tilemap[TILEMAP_SIZE_Y][TILEMAP_SIZE_X + 1];
 
+// Collision layer of a tilemap: one bitmask per row, bit `x` is set when tile [x, y] is solid.
+// Kept next to the `Tilemap` (see `insertLevelInMap`), so collision queries can test
+// whole rows with shifts and masks instead of comparing tiles one by one.
+typedef uint16_t TilemapSolids[TILEMAP_SIZE_Y];
+
+// All the columns of a row fit in one `TilemapSolids` row
+typedef char tilemapSolidsRowCheck[TILEMAP_SIZE_X <= 16 ? 1 : -1];
+#define TILEMAP_SOLIDS_ROW_FULL ((uint16_t)((1u << TILEMAP_SIZE_X) - 1))
+
 
 // List of tilemaps for each screen in the level.
 // Note: starts at the bottom, so it looks continuous
@@ -256,6 +265,19 @@ tilemapIsTileFull(const Tilemap* tilemap, int x, int y)
     return true;
 }
 
+// Build the collision layer from the tiles
+void
+tilemapComputeSolids(const Tilemap* tilemap, TilemapSolids* outSolids)
+{
+    for (int y = 0; y < TILEMAP_SIZE_Y; y++) {
+        uint16_t row = 0;
+        for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+            if (tilemapIsTileFull(tilemap, x, y)) row |= (uint16_t)(1u << x);
+        }
+        (*outSolids)[y] = row;
+    }
+}
+
 void printTile(void* v) {
     Tilemap* t = (Tilemap*)v;
     for (int i=0; i< TILEMAP_SIZE_X; i++) {
@@ -273,7 +295,7 @@ void printTile(void* v) {
 
 // Function to allocate memory for an array of n Tilemaps
 Tilemap* allocateTilemaps(size_t n) {
-    Tilemap* newTilemaps = malloc(n * sizeof(Tilemap));
+    Tilemap* newTilemaps = (Tilemap*)malloc(n * sizeof(Tilemap));
     if (!newTilemaps) {
         fprintf(stderr, "Memory allocation failed!\n");
         exit(EXIT_FAILURE);
@@ -281,9 +303,21 @@ Tilemap* allocateTilemaps(size_t n) {
     return newTilemaps;
 }
 
-// Function to copy an existing Tilemap into the i-th index of the allocated array
-void insertLevelInMap(const Tilemap* level, Tilemap* map, size_t pos) {
+// Function to allocate memory for the collision layers of n Tilemaps
+TilemapSolids* allocateTilemapSolids(size_t n) {
+    TilemapSolids* newSolids = (TilemapSolids*)malloc(n * sizeof(TilemapSolids));
+    if (!newSolids) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return newSolids;
+}
+
+// Function to copy an existing Tilemap into the i-th index of the allocated array,
+// and update the matching collision layer
+void insertLevelInMap(const Tilemap* level, Tilemap* map, TilemapSolids* solids, size_t pos) {
     memcpy(&map[pos], level, sizeof(Tilemap));  // Copy into the correct index
+    tilemapComputeSolids(&map[pos], &solids[pos]);
 }
 
 // Function to print a specific Tilemap from an allocated array
@@ -298,34 +332,302 @@ void freeTilemaps(Tilemap* tilemaps) {
     free(tilemaps);
 }
 
+void freeTilemapSolids(TilemapSolids* solids) {
+    free(solids);
+}
+
 Tilemap *mainTilemap;
+TilemapSolids *mainTilemapSolids;
 size_t numOfLevels = 5;
 
-Tilemap* createTilemap(size_t nLevels) {
+// Creates the level screens, and their collision layers in `outSolids`
+Tilemap* createTilemap(size_t nLevels, TilemapSolids** outSolids) {
 
   Tilemap* tilemap = allocateTilemaps(nLevels);
+  TilemapSolids* solids = allocateTilemapSolids(nLevels);
 
-  insertLevelInMap(&FINAL_SCREEN, tilemap, 0);
-  insertLevelInMap(&LEVEL4, tilemap, 1);
-  insertLevelInMap(&LEVEL3, tilemap, 2);
-  insertLevelInMap(&LEVEL2, tilemap, 3);
-  insertLevelInMap(&START_SCREEN, tilemap, 4);
-  /* insertLevelInMap(&START_SCREEN, tilemap, 2); */
+  insertLevelInMap(&FINAL_SCREEN, tilemap, solids, 0);
+  insertLevelInMap(&LEVEL4, tilemap, solids, 1);
+  insertLevelInMap(&LEVEL3, tilemap, solids, 2);
+  insertLevelInMap(&LEVEL2, tilemap, solids, 3);
+  insertLevelInMap(&START_SCREEN, tilemap, solids, 4);
+  /* insertLevelInMap(&START_SCREEN, tilemap, solids, 2); */
 
+  *outSolids = solids;
   return tilemap;
 }
 
+// Get the screen index, where start = 0 and increases when you move up (-Y)
+int
+getScreenHeightIndex(float height)
+{
+  return floorf(-height / TILEMAP_SIZE_Y);
+}
+
+// Index of the screen in `mainTilemap` at the given height (screens are stored top to bottom)
+int
+getScreenIndex(float height)
+{
+  int screenIndex = numOfLevels - getScreenHeightIndex(height) - 2;
+  if (screenIndex < 0 || (size_t)screenIndex > numOfLevels) {
+    screenIndex = 0;
+  }
+  return screenIndex;
+}
+
+// Offset of the screen at the given height along the Y axis
+float
+getScreenOffsetY(float height)
+{
+  return -(float)(getScreenHeightIndex(height) + 1) * TILEMAP_SIZE_Y;
+}
+
+const Tilemap*
+getScreenTilemap(int screenIndex)
+{
+  return &mainTilemap[screenIndex % numOfLevels];
+}
+
+const TilemapSolids*
+getScreenSolids(int screenIndex)
+{
+  return &mainTilemapSolids[screenIndex % numOfLevels];
+}
+
+// Collision rows of the whole level in world space, so boxes on the border between two
+// screens collide with both of them.
+// The screens' collision layers are stored top to bottom right after each other, so
+// the screens are the chunks of one tall grid, and world row `y` is simply `rows[y - topY]`.
+typedef struct {
+  const uint16_t* rows;
+  int rowCount;
+  int topY; // World Y of `rows[0]`
+  const uint8_t* distances; // `TilemapDistances` of the screens, row `y` at `y * TILEMAP_SIZE_X`. NULL when there are none.
+} WorldSolids;
+
+// Distance field of a screen: the Chebyshev distance (in tiles) from each tile to the nearest
+// full tile, 0 for full tiles, at most `TILEMAP_DISTANCE_MAX`. A box around a tile that's closer
+// than the distance can't touch anything full, so queries in the open skip looking at tiles at all.
+// Built when a screen becomes part of `mainTilemap` (see `buildMainTilemapDistances`).
+typedef uint8_t TilemapDistances[TILEMAP_SIZE_Y][TILEMAP_SIZE_X];
+
+// Full tiles farther than a screen aren't looked for, so a screen's distances only depend on it
+// and the screens right above and below it
+#define TILEMAP_DISTANCE_MAX TILEMAP_SIZE_Y
+// Ranges shorter than this are tested faster with the row masks alone (see `worldSolidsIsAnyFull`)
+#define TILEMAP_DISTANCE_MIN_ROWS 3
+
+TilemapDistances* mainTilemapDistances;
+// What `mainTilemapDistances` was built from, they're only used while it's still the current level
+const TilemapSolids* mainTilemapDistancesSolids;
+size_t mainTilemapDistancesCount;
+
+// View of any level's solids, laid out like the main level
+WorldSolids
+makeWorldSolids(const TilemapSolids* solids, size_t screenCount)
+{
+  WorldSolids world;
+  world.rows = (const uint16_t*)solids;
+  world.rowCount = (int)screenCount * TILEMAP_SIZE_Y;
+  // The last screen (the start) is at height index -1, see `getScreenOffsetY`
+  world.topY = -((int)screenCount - 1) * TILEMAP_SIZE_Y;
+  world.distances = NULL;
+  return world;
+}
+
+// View of the current level (`mainTilemapSolids`). Doesn't copy anything, but has to be
+// fetched again when the level is replaced.
+WorldSolids
+getWorldSolids(void)
+{
+  WorldSolids world = makeWorldSolids(mainTilemapSolids, numOfLevels);
+  if (mainTilemapDistancesSolids == mainTilemapSolids && mainTilemapDistancesCount == numOfLevels) {
+    world.distances = (const uint8_t*)mainTilemapDistances;
+  }
+  return world;
+}
+
+// View of a single screen, at the top of the world
+WorldSolids
+getScreenWorldSolids(const TilemapSolids* solids)
+{
+  WorldSolids world = { *solids, TILEMAP_SIZE_Y, 0 };
+  return world;
+}
+
+bool
+worldSolidsIsTileFull(const WorldSolids* world, int x, int y)
+{
+  if (x < 0 || x >= TILEMAP_SIZE_X) return OUTSIDE_TILE_HORIZONTAL == TILE_FULL;
+  y -= world->topY;
+  if (y < 0 || y >= world->rowCount) return OUTSIDE_TILE_VERTICAL == TILE_FULL;
+  return (world->rows[y] >> x) & 1;
+}
+
+// Distance from tile [x, y] to the nearest full tile, 0 when unknown (no distance field, or outside of the level)
+int
+getWorldSolidsDistance(const WorldSolids* world, int x, int y)
+{
+  y -= world->topY;
+  if (!world->distances || x < 0 || x >= TILEMAP_SIZE_X || y < 0 || y >= world->rowCount) return 0;
+  return world->distances[y * TILEMAP_SIZE_X + x];
+}
+
+// Whether the distance field alone tells that no tile in the (inclusive) tile rectangle is full.
+// False when it can't tell, then the tiles have to be looked at.
+bool
+worldSolidsIsRangeClear(const WorldSolids* world, int startX, int startY, int endX, int endY)
+{
+  const int centerX = (startX + endX) / 2;
+  const int centerY = (startY + endY) / 2;
+  int reach = endX - centerX > centerX - startX ? endX - centerX : centerX - startX;
+  if (endY - centerY > reach) reach = endY - centerY;
+  if (centerY - startY > reach) reach = centerY - startY;
+  return getWorldSolidsDistance(world, centerX, centerY) > reach;
+}
+
+// Is any tile in the (inclusive) tile rectangle solid?
+// Tiles outside of the grid follow `OUTSIDE_TILE_HORIZONTAL` and `OUTSIDE_TILE_VERTICAL`.
+bool
+worldSolidsIsAnyFull(const WorldSolids* world, int startX, int startY, int endX, int endY)
+{
+  if (startX > endX || startY > endY) return false;
+  // Tall ranges (long moves) take a row each below, the distance field can tell them all at once
+  if (endY - startY >= TILEMAP_DISTANCE_MIN_ROWS && worldSolidsIsRangeClear(world, startX, startY, endX, endY)) return false;
+  startY -= world->topY;
+  endY -= world->topY;
+  if ((startX < 0 || endX >= TILEMAP_SIZE_X) && OUTSIDE_TILE_HORIZONTAL == TILE_FULL) return true;
+  if ((startY < 0 || endY >= world->rowCount) && OUTSIDE_TILE_VERTICAL == TILE_FULL) return true;
+
+  if (startX < 0) startX = 0;
+  if (endX >= TILEMAP_SIZE_X) endX = TILEMAP_SIZE_X - 1;
+  if (startY < 0) startY = 0;
+  if (endY >= world->rowCount) endY = world->rowCount - 1;
+  if (startX > endX || startY > endY) return false;
+
+  const uint16_t columns = (uint16_t)((TILEMAP_SOLIDS_ROW_FULL >> (TILEMAP_SIZE_X - 1 - (endX - startX))) << startX);
+  uint16_t rows = 0;
+  for (int y = startY; y <= endY; y++) {
+    rows |= world->rows[y];
+  }
+  return (rows & columns) != 0;
+}
+
+// Distance field tile of the window in `computeScreenDistances`, tiles outside of it are
+// full or far away
+uint8_t
+getDistanceWindowTile(uint8_t window[3 * TILEMAP_SIZE_Y][TILEMAP_SIZE_X], int rowCount, bool isWorldTop, bool isWorldBottom, int x, int y)
+{
+  if (x < 0 || x >= TILEMAP_SIZE_X) return OUTSIDE_TILE_HORIZONTAL == TILE_FULL ? 0 : TILEMAP_DISTANCE_MAX;
+  if (y < 0) return isWorldTop && OUTSIDE_TILE_VERTICAL == TILE_FULL ? 0 : TILEMAP_DISTANCE_MAX;
+  if (y >= rowCount) return isWorldBottom && OUTSIDE_TILE_VERTICAL == TILE_FULL ? 0 : TILEMAP_DISTANCE_MAX;
+  return window[y][x];
+}
+
+// Distance field of screen `screenIndex` of `world` (screens top to bottom, like `mainTilemapSolids`).
+// Two passes over the screen and its neighbors (a chamfer distance transform): the first
+// takes the distance from the tiles left and above, the second from the right and below,
+// which is exact for the Chebyshev distance.
+void
+computeScreenDistances(const WorldSolids* world, int screenIndex, TilemapDistances* outDistances)
+{
+  const int firstRow = screenIndex > 0 ? (screenIndex - 1) * TILEMAP_SIZE_Y : 0;
+  const int endRow = (screenIndex + 2) * TILEMAP_SIZE_Y < world->rowCount ? (screenIndex + 2) * TILEMAP_SIZE_Y : world->rowCount;
+  const int rowCount = endRow - firstRow;
+  const bool isWorldTop = firstRow == 0;
+  const bool isWorldBottom = endRow == world->rowCount;
+
+  // Neighbors each pass has already visited: above and left for the first, below and right for the second
+  const int neighbors[4][2] = { { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 } };
+
+  uint8_t window[3 * TILEMAP_SIZE_Y][TILEMAP_SIZE_X];
+  for (int y = 0; y < rowCount; y++) {
+    const uint16_t row = world->rows[firstRow + y];
+    for (int x = 0; x < TILEMAP_SIZE_X; x++) {
+      int distance = ((row >> x) & 1) ? 0 : TILEMAP_DISTANCE_MAX;
+      for (int i = 0; i < 4 && distance > 0; i++) {
+        const int neighbor = getDistanceWindowTile(window, rowCount, isWorldTop, isWorldBottom, x + neighbors[i][0], y + neighbors[i][1]) + 1;
+        if (neighbor < distance) distance = neighbor;
+      }
+      window[y][x] = (uint8_t)distance;
+    }
+  }
+  for (int y = rowCount - 1; y >= 0; y--) {
+    for (int x = TILEMAP_SIZE_X - 1; x >= 0; x--) {
+      int distance = window[y][x];
+      for (int i = 0; i < 4 && distance > 0; i++) {
+        const int neighbor = getDistanceWindowTile(window, rowCount, isWorldTop, isWorldBottom, x - neighbors[i][0], y - neighbors[i][1]) + 1;
+        if (neighbor < distance) distance = neighbor;
+      }
+      window[y][x] = (uint8_t)distance;
+    }
+  }
+
+  memcpy(outDistances, window[screenIndex * TILEMAP_SIZE_Y - firstRow], sizeof(TilemapDistances));
+}
+
+// Build the distance fields of every screen of the current level (`mainTilemapSolids`).
+// Call whenever `mainTilemapSolids` is replaced; `getWorldSolids` leaves them out until then.
+void
+buildMainTilemapDistances(void)
+{
+  free(mainTilemapDistances);
+  mainTilemapDistances = (TilemapDistances*)malloc((numOfLevels > 0 ? numOfLevels : 1) * sizeof(TilemapDistances));
+  if (!mainTilemapDistances) {
+    fprintf(stderr, "Memory allocation failed!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  const WorldSolids world = makeWorldSolids(mainTilemapSolids, numOfLevels);
+  for (size_t i = 0; i < numOfLevels; i++) {
+    computeScreenDistances(&world, (int)i, &mainTilemapDistances[i]);
+  }
+  mainTilemapDistancesSolids = mainTilemapSolids;
+  mainTilemapDistancesCount = numOfLevels;
+}
+
+// A screen of the current level changed (e.g. a hot reload), its distances and its neighbors' change with it
+void
+updateMainTilemapDistances(int screenIndex)
+{
+  if (mainTilemapDistancesSolids != mainTilemapSolids || mainTilemapDistancesCount != numOfLevels) return;
+
+  const WorldSolids world = makeWorldSolids(mainTilemapSolids, numOfLevels);
+  for (int i = screenIndex - 1; i <= screenIndex + 1; i++) {
+    if (i < 0 || (size_t)i >= numOfLevels) continue;
+    computeScreenDistances(&world, i, &mainTilemapDistances[i]);
+  }
+}
+
+void
+freeMainTilemapDistances(void)
+{
+  free(mainTilemapDistances);
+  mainTilemapDistances = NULL;
+  mainTilemapDistancesSolids = NULL;
+  mainTilemapDistancesCount = 0;
+}
+
 void printMap(Tilemap* tilemap) {
     for (size_t i=0; i<numOfLevels; i++) {
         printLevel(tilemap, i);
     }
 }
 
-Tilemap* reloadTilemap(size_t nLevels) {
+// Replace all the screens of `mainTilemap` with `nLevels` new ones.
+// Note: `mainTilemap` must have been allocated here (not mapped from a level file).
+Tilemap* reloadTilemap(const Tilemap* levels, size_t nLevels) {
 
   free(mainTilemap);
+  free(mainTilemapSolids);
   mainTilemap = allocateTilemaps(nLevels);
+  mainTilemapSolids = allocateTilemapSolids(nLevels);
 
+  for (size_t i = 0; i < nLevels; i++) {
+    insertLevelInMap(&levels[i], mainTilemap, mainTilemapSolids, i);
+  }
+  numOfLevels = nLevels;
+  buildMainTilemapDistances();
 
   return mainTilemap;
 }
@@ -0,0 +1,96 @@
+
+// Notices when a file was saved, without blocking.
+// On Linux this uses inotify on the file's directory (editors often save by writing a new
+// file and renaming it over the old one, which a watch on the file itself would miss).
+// Elsewhere it falls back to comparing the modification time.
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h> // read, close
+#endif
+
+typedef struct {
+    char directory[256];
+    char baseName[256];
+    char path[256];
+    int fd; // inotify instance, -1 when not available
+    time_t modTime; // Fallback when there's no inotify
+} FileWatcher;
+
+time_t
+getFileModTimeForWatcher(const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    return st.st_mtime;
+}
+
+bool
+startFileWatcher(FileWatcher* watcher, const char* path)
+{
+    memset(watcher, 0, sizeof(*watcher));
+    watcher->fd = -1;
+    snprintf(watcher->path, sizeof(watcher->path), "%s", path);
+
+    const char* slash = strrchr(path, '/');
+    if (slash) {
+        snprintf(watcher->directory, sizeof(watcher->directory), "%.*s", (int)(slash - path), path);
+        snprintf(watcher->baseName, sizeof(watcher->baseName), "%s", slash + 1);
+    } else {
+        snprintf(watcher->directory, sizeof(watcher->directory), ".");
+        snprintf(watcher->baseName, sizeof(watcher->baseName), "%s", path);
+    }
+    if (watcher->directory[0] == '\0') snprintf(watcher->directory, sizeof(watcher->directory), "/");
+
+    watcher->modTime = getFileModTimeForWatcher(path);
+
+#if defined(__linux__)
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher->fd >= 0 &&
+        inotify_add_watch(watcher->fd, watcher->directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(watcher->fd);
+        watcher->fd = -1;
+    }
+#endif
+    return true;
+}
+
+void
+stopFileWatcher(FileWatcher* watcher)
+{
+#if defined(__linux__)
+    if (watcher->fd >= 0) close(watcher->fd);
+#endif
+    watcher->fd = -1;
+}
+
+// Has the file been saved since the last call? Never blocks.
+bool
+pollFileWatcher(FileWatcher* watcher)
+{
+#if defined(__linux__)
+    if (watcher->fd >= 0) {
+        bool isChanged = false;
+        // Events are variable-sized, the buffer must be aligned for `struct inotify_event`
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        for (;;) {
+            const ssize_t length = read(watcher->fd, buffer, sizeof(buffer));
+            if (length <= 0) break;
+
+            for (ssize_t offset = 0; offset < length;) {
+                const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+                if (event->len > 0 && strcmp(event->name, watcher->baseName) == 0) isChanged = true;
+                offset += (ssize_t)sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return isChanged;
+    }
+#endif
+
+    const time_t modTime = getFileModTimeForWatcher(watcher->path);
+    if (modTime == watcher->modTime) return false;
+    watcher->modTime = modTime;
+    return true;
+}